@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Bump allocator owning a tree of objects. Objects are never destroyed individually; all of their storage
+// is released at once when the arena goes away, so anything placed in it must only own arena memory.
+class Arena
+{
+public:
+    static constexpr size_t BlockSize = 64 * 1024;
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char *ptr = nullptr;
+    char *end = nullptr;
+
+public:
+    Arena() = default;
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *Allocate(size_t size, size_t align)
+    {
+        auto aligned = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(ptr) + align - 1) & ~(uintptr_t)(align - 1));
+        if (ptr == nullptr || aligned + size > end)
+            return AllocateSlow(size, align);
+        ptr = aligned + size;
+        return aligned;
+    }
+
+    template <typename T, typename... Args>
+    T *New(Args &&...args)
+    {
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+private:
+    void *AllocateSlow(size_t size, size_t align);
+};
+
+// Allocator for containers living inside arena owned objects. Freed memory is only reclaimed with the arena.
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    Arena *arena;
+
+    ArenaAllocator(Arena &arena) : arena{&arena} {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena{other.arena} {}
+
+    T *allocate(size_t n) { return static_cast<T *>(arena->Allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T *, size_t) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const { return arena != other.arena; }
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
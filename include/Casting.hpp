@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cassert>
+#include <type_traits>
+
+// LLVM style isa/cast/dyn_cast for hierarchies that report their kind through GetType(). Every concrete class
+// names its tag in a static Kind, so testing a node is one compare instead of an RTTI walk. Debug builds also
+// check the tag against dynamic_cast to catch classes that share or misreport a kind.
+
+template <typename T, typename From>
+using CastResult = std::conditional_t<std::is_const_v<From>, const T *, T *>;
+
+template <typename T, typename From>
+inline bool isa(const From *node)
+{
+    assert(node && "isa<> used on a null pointer");
+    if constexpr (std::is_base_of_v<T, From>)
+        return true;
+    else
+        return node->GetType() == T::Kind;
+}
+
+template <typename T, typename From>
+inline CastResult<T, From> cast(From *node)
+{
+    assert(isa<T>(node) && "cast<> argument of incompatible type");
+    using Result = CastResult<T, From>;
+    assert(dynamic_cast<Result>(node) == static_cast<Result>(node) && "Kind does not match the dynamic type");
+    return static_cast<Result>(node);
+}
+
+template <typename T, typename From>
+inline CastResult<T, From> dyn_cast(From *node)
+{
+    return isa<T>(node) ? cast<T>(node) : nullptr;
+}
+
+template <typename T, typename From>
+inline CastResult<T, From> dyn_cast_or_null(From *node)
+{
+    return node ? dyn_cast<T>(node) : nullptr;
+}
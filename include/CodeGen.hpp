@@ -4,8 +4,11 @@
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Value.h>
+#include <llvm/Support/CodeGen.h>
 
 #include <map>
+#include <tuple>
+#include <optional>
 #include <unordered_map>
 #include <string>
 #include <bitset>
@@ -14,20 +17,33 @@
 
 #include <Token.hpp>
 #include <Errors.hpp>
+#include <IdMap.hpp>
+#include <Casting.hpp>
+#include <Ref.hpp>
 
 // std::string gen_random(const int len);
 // #include <Parser.hpp>
 namespace Parsing
 {
     class SyntaxNode;
+    class FlatTree;
     class GenericParameter;
     class GenericType;
 } // namespace Parsing
 
-extern size_t numCodeType;
-extern size_t numCodeValue;
+namespace llvm
+{
+    class TargetMachine;
+    namespace orc
+    {
+        class ThreadSafeModule;
+    } // namespace orc
+} // namespace llvm
 
-struct CodeType
+extern thread_local size_t numCodeType;
+extern thread_local size_t numCodeValue;
+
+struct CodeType : public RefCounted
 {
     llvm::Type *type;
     bool isSigned;
@@ -48,6 +64,8 @@ struct CodeType
 
     bool operator==(const CodeType &right) const
     {
+        if (this == &right)
+            return true;
         return type == right.type && isSigned == right.isSigned;
     }
 
@@ -57,12 +75,12 @@ struct CodeType
     }
 };
 
-struct CodeValue
+struct CodeValue : public RefCounted
 {
     llvm::Value *value;
-    std::shared_ptr<CodeType> type;
+    Ref<CodeType> type;
 
-    CodeValue(llvm::Value *value, std::shared_ptr<CodeType> type) : value{value}, type{type}
+    CodeValue(llvm::Value *value, Ref<CodeType> type) : value{value}, type{type}
     {
         numCodeValue++;
     }
@@ -78,14 +96,14 @@ struct CodeValue
 struct FunctionCodeType : public CodeType
 {
 private:
-    std::shared_ptr<CodeType> returnType;
-    std::vector<std::shared_ptr<CodeType>> parameters;
+    Ref<CodeType> returnType;
+    std::vector<Ref<CodeType>> parameters;
     bool isMember;
 
 public:
     FunctionCodeType(
-        std::shared_ptr<CodeType> returnType,
-        std::vector<std::shared_ptr<CodeType>> parameters,
+        Ref<CodeType> returnType,
+        std::vector<Ref<CodeType>> parameters,
         bool isMember) : CodeType(nullptr), returnType{returnType}, parameters{parameters}, isMember{isMember}
     {
     }
@@ -110,7 +128,7 @@ public:
 public:
     FunctionCodeValue(
         llvm::Function *value,
-        std::shared_ptr<FunctionCodeType> functionType,
+        Ref<FunctionCodeType> functionType,
         llvm::AllocaInst *retLoc = nullptr,
         llvm::BasicBlock *retLabel = nullptr) : CodeValue(value, functionType), retLoc{retLoc}, retLabel{retLabel}
     {
@@ -133,7 +151,7 @@ public:
     void SetReturnLabel(llvm::BasicBlock *ret) { retLabel = ret; }
     void IncNumRets() { numRets++; }
 
-    auto GetFunctionType() { return std::static_pointer_cast<FunctionCodeType>(type); }
+    auto GetFunctionType() { return StaticRefCast<FunctionCodeType>(type); }
 };
 
 class TemplateNode;
@@ -182,9 +200,9 @@ struct SpecCodeType : public CodeType
 
 struct ArrayCodeType : public CodeType
 {
-    std::shared_ptr<CodeType> baseType;
+    Ref<CodeType> baseType;
 
-    ArrayCodeType(llvm::Type *type, std::shared_ptr<CodeType> baseType) : CodeType(type), baseType{baseType}
+    ArrayCodeType(llvm::Type *type, Ref<CodeType> baseType) : CodeType(type), baseType{baseType}
     {
     }
 
@@ -192,7 +210,7 @@ struct ArrayCodeType : public CodeType
     {
     }
 
-    std::shared_ptr<CodeType> GetBaseType() { return baseType; }
+    Ref<CodeType> GetBaseType() { return baseType; }
 };
 
 class CodeGeneration;
@@ -219,9 +237,21 @@ concept IsSymbolNode = std::is_base_of<SymbolNode, T>::value;
 class SymbolNode
 {
 public:
-    std::unordered_map<std::string, SymbolNode *> children;
+    static constexpr SymbolNodeType Kind = SymbolNodeType::SymbolNode;
+
+public:
+    IdMap<SymbolNode *> children;
     SymbolNode *parent;
+    InternId name = InvalidInternId; // Name this node was added under in parent
     bool isExported = false;
+    uint64_t generatedNames = 0;
+    const Parsing::SyntaxNode *declaration = nullptr; // Declaration still to be resolved, see CodeGeneration::Resolve
+
+private:
+    mutable std::optional<std::string> mangledPrefix;
+    mutable IdMap<uint32_t> missingNames; // Names not visible from this scope, tagged with their NameEpoch
+
+    static inline thread_local std::vector<uint32_t> nameEpochs; // Symbol trees never leave the thread that built them
 
 public:
     SymbolNode(SymbolNode *parent) : parent{parent} {}
@@ -233,91 +263,109 @@ public:
 
     const virtual SymbolNodeType GetType() const { return SymbolNodeType::SymbolNode; }
 
-    virtual const std::unordered_map<std::string, SymbolNode *>::const_iterator findSymbol(const std::string &name) const
+    virtual const IdMap<SymbolNode *>::const_iterator findSymbol(InternId name) const
     {
         return children.find(name);
     }
 
     const std::string findSymbol(SymbolNode *child) const
     {
-        for (auto &c : children)
-        {
-            if (c.second == child)
-                return c.first;
-        }
+        if (child->parent == this)
+            return std::string(child->GetName());
         return "";
     }
 
-    auto IndexOf(std::unordered_map<std::string, SymbolNode *>::const_iterator node) const
+    auto GetParent() { return parent; }
+    std::string_view GetName() const { return Interner::Get(name); }
+
+    // Length prefixed names of this node and its ancestors below the root, built once from the parent's
+    const std::string &GetMangledPrefix() const
     {
-        std::unordered_map<std::string, SymbolNode *>::const_iterator begin = children.begin();
-        int index = 0;
-        for (auto &c : children)
+        if (!mangledPrefix)
         {
-            if (c.second->GetType() == SymbolNodeType::VariableNode)
+            if (parent == nullptr)
+                mangledPrefix.emplace();
+            else
             {
-                if (c == *node)
-                {
-                    break;
-                }
-                index++;
+                auto nname = GetName();
+                mangledPrefix = parent->GetMangledPrefix() + std::to_string(nname.size()) + std::string(nname);
             }
         }
-        return index;
-        // return std::distance(begin, node);
+        return *mangledPrefix;
     }
 
-    auto GetParent() { return parent; }
     const auto &GetChildren() const { return children; }
 
-    void AddChild(const std::string &symbolName, SymbolNode *child)
+    // Bumped whenever a symbol with this name is added anywhere, invalidating cached misses for it
+    static uint32_t NameEpoch(InternId name) { return name < nameEpochs.size() ? nameEpochs[name] : 0; }
+
+    bool IsKnownMissing(InternId name) const
+    {
+        auto found = missingNames.find(name);
+        return found != missingNames.end() && found->second == NameEpoch(name);
+    }
+
+    void SetKnownMissing(InternId name) const { missingNames[name] = NameEpoch(name); }
+
+    void AddChild(InternId symbolName, SymbolNode *child)
     {
-        children.insert(std::pair<std::string, SymbolNode *>(symbolName, child));
+        child->name = symbolName;
+        children.insert(std::pair<InternId, SymbolNode *>(symbolName, child));
+        BumpNameEpoch(symbolName);
     }
 
     template <IsSymbolNode T, typename... Args>
-    T *AddChild(const std::string &symbolName, Args... args)
+    T *AddChild(InternId symbolName, Args... args)
     {
         if (findSymbol(symbolName) != children.end())
         {
             // TODO throw error symbol already exists
         }
         auto child = new T(this, args...);
-        children.insert(std::pair<std::string, SymbolNode *>(symbolName, child));
+        child->name = symbolName;
+        children.insert(std::pair<InternId, SymbolNode *>(symbolName, child));
+        BumpNameEpoch(symbolName);
         return child;
     }
 
+    // Identifiers can't contain '$' so a per-node counter is enough to keep generated names unique
     std::string GenerateName()
     {
-        std::string s;
-        uint64_t scope = 0;
-        do
-        {
-            s = "$";
-            s += std::to_string(scope++);
-        } while (findSymbol(s) != children.end());
-        return s;
+        return "$" + std::to_string(generatedNames++);
     }
 
     template <typename T>
-    const T &As() const { return *dynamic_cast<const T *>(this); }
+    const T &As() const { return *cast<T>(this); }
 
     template <typename T>
-    T &As() { return *dynamic_cast<T *>(this); }
+    T &As() { return *cast<T>(this); }
 
     template <typename T>
-    const T *Cast() const { return dynamic_cast<const T *>(this); }
+    const T *Cast() const { return dyn_cast<T>(this); }
 
     template <typename T>
-    T *Cast() { return dynamic_cast<T *>(this); }
+    T *Cast() { return dyn_cast<T>(this); }
 
     void Export() { isExported = true; }
     void NoExport() { isExported = false; }
     bool IsExported() const { return isExported; }
+
+    void Defer(const Parsing::SyntaxNode *declaration) { this->declaration = declaration; }
+    bool IsDeferred() const { return declaration != nullptr; }
+
+private:
+    static void BumpNameEpoch(InternId name)
+    {
+        if (name >= nameEpochs.size())
+            nameEpochs.resize(name + 1);
+        nameEpochs[name]++;
+    }
 };
 
 class PackageNode : public SymbolNode
 {
+public:
+    static constexpr SymbolNodeType Kind = SymbolNodeType::PackageNode;
 
 public:
     PackageNode(SymbolNode *parent) : SymbolNode{parent} {}
@@ -328,6 +376,9 @@ public:
 
 class ModuleNode : public SymbolNode
 {
+public:
+    static constexpr SymbolNodeType Kind = SymbolNodeType::ModuleNode;
+
 private:
     CodeGeneration *moduleInfo;
 
@@ -342,30 +393,36 @@ public:
 
 class FunctionNode : public SymbolNode
 {
+public:
+    static constexpr SymbolNodeType Kind = SymbolNodeType::FunctionNode;
+
 private:
-    std::shared_ptr<FunctionCodeValue> function;
+    Ref<FunctionCodeValue> function;
 
 public:
-    FunctionNode(SymbolNode *parent, std::shared_ptr<FunctionCodeValue> function) : SymbolNode{parent}, function{function} {}
+    FunctionNode(SymbolNode *parent, Ref<FunctionCodeValue> function) : SymbolNode{parent}, function{function} {}
     virtual ~FunctionNode() {}
 
     const virtual SymbolNodeType GetType() const override { return SymbolNodeType::FunctionNode; }
 
-    std::shared_ptr<FunctionCodeValue> GetFunction() const { return function; }
+    Ref<FunctionCodeValue> GetFunction() const { return function; }
 };
 
 class VariableNode : public SymbolNode
 {
+public:
+    static constexpr SymbolNodeType Kind = SymbolNodeType::VariableNode;
+
 private:
-    std::shared_ptr<CodeValue> variable;
+    Ref<CodeValue> variable;
 
 public:
-    VariableNode(SymbolNode *parent, std::shared_ptr<CodeValue> variable) : SymbolNode{parent}, variable{variable} {}
+    VariableNode(SymbolNode *parent, Ref<CodeValue> variable) : SymbolNode{parent}, variable{variable} {}
     virtual ~VariableNode() {}
 
     const virtual SymbolNodeType GetType() const override { return SymbolNodeType::VariableNode; }
 
-    std::shared_ptr<CodeValue> GetVariable() const { return variable; }
+    Ref<CodeValue> GetVariable() const { return variable; }
 };
 
 // class ActionNode : public SymbolNode
@@ -384,21 +441,26 @@ class Spec;
 
 class TemplateNode : public SymbolNode
 {
+public:
+    static constexpr SymbolNodeType Kind = SymbolNodeType::TemplateNode;
+
 private:
-    std::shared_ptr<TemplateCodeType> templ;
+    Ref<TemplateCodeType> templ;
     std::vector<llvm::Type *> members;
     bool isGeneric = false;
     Parsing::GenericParameter *generic = nullptr;
     // std::vector<std::shared_ptr<CodeType>> genericParameters;
     Parsing::SyntaxNode *body = nullptr;
-    std::vector<std::string> orderedMembers;
+    std::vector<InternId> orderedMembers; // Field names in layout order, parallel to members
+    std::unordered_map<InternId, int> memberIndices; // Field name to its index in the struct
     std::vector<SpecNode *> implementedSpecs;
+    std::vector<const Parsing::SyntaxNode *> actions; // Action statements on this template, resolved along with it
 
 public:
-    TemplateNode(SymbolNode *parent, llvm::StructType *templ) : SymbolNode{parent}, templ{std::make_shared<TemplateCodeType>(templ, *this)} {}
+    TemplateNode(SymbolNode *parent, llvm::StructType *templ) : SymbolNode{parent}, templ{MakeRef<TemplateCodeType>(templ, *this)} {}
     TemplateNode(SymbolNode *parent, Parsing::GenericParameter *generic, Parsing::SyntaxNode *body) : SymbolNode{parent}, templ{nullptr}, generic{generic}, isGeneric{true}, body{body} {}
     // TemplateNode(SymbolNode *parent, const std::vector<std::shared_ptr<CodeType>> &genericParameters) : SymbolNode{parent}, templ{nullptr}, genericParameters{genericParameters} {}
-    TemplateNode(SymbolNode *parent, TemplateNode &node, llvm::StructType *templ) : SymbolNode(parent), templ{std::make_shared<TemplateCodeType>(templ, *this)}, members{node.members} {}
+    TemplateNode(SymbolNode *parent, TemplateNode &node, llvm::StructType *templ) : SymbolNode(parent), templ{MakeRef<TemplateCodeType>(templ, *this)}, members{node.members}, orderedMembers{node.orderedMembers}, memberIndices{node.memberIndices} {}
 
     virtual ~TemplateNode()
     {
@@ -422,8 +484,9 @@ public:
     // }
 
     const auto GetTemplate() const { return templ; }
-    void AddMember(llvm::Type *val, std::string str)
+    void AddMember(llvm::Type *val, InternId str)
     {
+        memberIndices.emplace(str, static_cast<int>(members.size()));
         members.push_back(val);
         orderedMembers.push_back(str);
     }
@@ -432,23 +495,24 @@ public:
     bool IsGeneric() const { return isGeneric; }
     auto GetGeneric() const { return generic; }
     auto GetBody() { return body; }
-    int IndexOf(const std::string &str) const
+    int IndexOf(InternId str) const
     {
-        for (size_t i = 0; i < orderedMembers.size(); i++)
-            if (orderedMembers[i] == str)
-                return i;
-        return -1;
+        auto found = memberIndices.find(str);
+        return found != memberIndices.end() ? found->second : -1;
     }
     void Implement(SpecNode &spec) { implementedSpecs.push_back(&spec); }
     const auto &GetImplementedSpecs() const { return implementedSpecs; }
-    // const auto &GetAction() const { return actions; }
-    // void AddAction(ActionNode *action) { actions.push_back(action); }
+    const auto &GetActions() const { return actions; }
+    void AddAction(const Parsing::SyntaxNode *action) { actions.push_back(action); }
 };
 
 class TypeAliasNode : public SymbolNode
 {
+public:
+    static constexpr SymbolNodeType Kind = SymbolNodeType::TypeAliasNode;
+
 private:
-    std::shared_ptr<CodeType> type;
+    Ref<CodeType> type;
     Parsing::GenericParameter *generic = nullptr;
     bool isGeneric = false;
     Parsing::SyntaxNode *body = nullptr;
@@ -463,7 +527,7 @@ public:
     const virtual SymbolNodeType GetType() const override { return SymbolNodeType::TypeAliasNode; }
 
     auto GetReferencedType() const { return type; }
-    auto SetReferencedType(std::shared_ptr<CodeType> type) { this->type = type; }
+    auto SetReferencedType(Ref<CodeType> type) { this->type = type; }
 
     bool IsGeneric() const { return isGeneric; }
     // const auto &GetGenericParameters() const { return genericParameters; }
@@ -474,6 +538,9 @@ public:
 
 class ScopeNode : public SymbolNode
 {
+public:
+    static constexpr SymbolNodeType Kind = SymbolNodeType::ScopeNode;
+
 private:
 public:
     ScopeNode(SymbolNode *parent) : SymbolNode{parent} {}
@@ -484,6 +551,9 @@ public:
 
 class SpecNode : public SymbolNode
 {
+public:
+    static constexpr SymbolNodeType Kind = SymbolNodeType::SpecNode;
+
 private:
 public:
     SpecNode(SymbolNode *parent) : SymbolNode{parent} {}
@@ -494,6 +564,17 @@ public:
 
 void PrintSymbols(const SymbolNode &node, const std::string &name = "root", int index = 0, const std::wstring &indent = L"", bool last = false);
 
+// Levels of the default LLVM pipelines, like clang's -O flags
+enum class OptimizationLevel
+{
+    O0,
+    O1,
+    O2,
+    O3,
+    Os,
+    Oz
+};
+
 class CodeGeneration
 {
 
@@ -502,35 +583,62 @@ public:
     {
         Export,
         NoBlock,
-        Reference
+        Reference,
+        Deferred
     };
 
 public:
     SymbolNode rootSymbols{nullptr};
 
 private:
-    llvm::LLVMContext context;
+    std::unique_ptr<llvm::LLVMContext> contextOwner; // Given away with the module by TakeModule
+    llvm::LLVMContext &context;
     llvm::IRBuilder<> builder;
     llvm::Module *module;
 
     SymbolNode *insertPoint = nullptr;
-    std::shared_ptr<FunctionCodeValue> currentFunction;
-    std::shared_ptr<CodeValue> currentVar;
-    std::shared_ptr<CodeType> currentType;
-    std::shared_ptr<CodeValue> dotExprBase;
+    Ref<FunctionCodeValue> currentFunction;
+    Ref<CodeValue> currentVar;
+    Ref<CodeType> currentType;
+    Ref<CodeValue> dotExprBase;
     Range currentRange;
 
     std::bitset<64> usings;
 
     uint8_t preCodeGenPass = 0;
 
+    // Function bodies are split between this many instances by name, each generating its own module
+    unsigned partition = 0;
+    unsigned partitions = 1;
+
+    // Top level declarations in source order. Templates, specs and aliases only get their later passes once a
+    // lookup resolves them
+    std::vector<const Parsing::SyntaxNode *> typeDeclarations;     // Pass 0: templates, specs and aliases
+    std::vector<const Parsing::SyntaxNode *> actionDeclarations;   // Filed under their template after pass 0
+    std::vector<const Parsing::SyntaxNode *> functionDeclarations; // Pass 30: functions
+    std::vector<const Parsing::SyntaxNode *> deferredDefinitions;  // Actions whose bodies are generated after the module
+
+    // Instantiated generic types keyed on the generic symbol and the identity of each argument type, see
+    // GenericInstanceKey
+    using GenericInstance = std::pair<SymbolNode *, std::vector<std::pair<const void *, llvm::Type *>>>;
+    std::map<GenericInstance, Ref<CodeType>> genericInstances;
+
+    // Canonical plain and array types, so equal types share one CodeType and compare by address
+    using PlainTypeKey = std::tuple<llvm::Type *, bool, bool, bool>;
+    std::map<PlainTypeKey, Ref<CodeType>> plainTypes;
+    std::map<std::pair<llvm::Type *, CodeType *>, Ref<ArrayCodeType>> arrayTypes;
+
     static ErrorList errors;
 
 public:
-    CodeGeneration(const std::string &moduleName) : builder{context}, module{new llvm::Module(moduleName, context)}
+    // Code generation reads the data layout, so the target is set before anything is generated
+    CodeGeneration(const std::string &moduleName, const llvm::TargetMachine *target = nullptr, unsigned partition = 0, unsigned partitions = 1) : contextOwner{std::make_unique<llvm::LLVMContext>()}, context{*contextOwner}, builder{context}, module{new llvm::Module(moduleName, context)}, partition{partition}, partitions{partitions}
     {
+        if (target)
+            SetTarget(*target);
+
         insertPoint = &rootSymbols;
-        NewScope<ModuleNode>(moduleName);
+        NewScope<ModuleNode>(Interner::Intern(moduleName));
     }
 
     ~CodeGeneration()
@@ -542,22 +650,56 @@ public:
     auto &GetBuilder() { return builder; }
     auto &GetModule() const { return *module; }
 
-    std::shared_ptr<CodeType> LiteralType(const Parsing::SyntaxNode &node);
-    std::shared_ptr<CodeType> TypeType(const Parsing::SyntaxNode &node);
+    Ref<CodeType> GetCodeType(llvm::Type *type, bool isSigned = false, bool isChar = false, bool isBool = false);
+    Ref<CodeType> GetCodeType(const CodeType &type);
+    Ref<ArrayCodeType> GetArrayCodeType(llvm::Type *type, Ref<CodeType> baseType);
+    Ref<CodeType> Retype(const Ref<CodeType> &type, llvm::Type *to);
+    Ref<CodeType> LiteralType(const Parsing::SyntaxNode &node);
+    Ref<CodeType> TypeType(const Parsing::SyntaxNode &node);
     bool TypeImplements(const Parsing::SyntaxNode &node, SpecNode *spec);
-    bool TypeImplements(std::shared_ptr<CodeType> type, SpecNode *spec);
-    std::shared_ptr<CodeValue> Cast(std::shared_ptr<CodeValue> value, std::shared_ptr<CodeType> toType, bool implicit = true);
+    bool TypeImplements(Ref<CodeType> type, SpecNode *spec);
+    Ref<CodeValue> Cast(Ref<CodeValue> value, Ref<CodeType> toType, bool implicit = true);
     static uint8_t GetNumBits(uint64_t val);
-    std::shared_ptr<TemplateCodeType> TypeFromObjectInitializer(const Parsing::SyntaxNode &object);
-    std::shared_ptr<CodeType> TypeFromArrayInitializer(const Parsing::SyntaxNode &object);
-    std::shared_ptr<CodeValue> FollowDotChain(const Parsing::SyntaxNode &);
-    std::shared_ptr<CodeType> GenerateGenericType(Parsing::GenericType *generic);
+    Ref<TemplateCodeType> TypeFromObjectInitializer(const Parsing::SyntaxNode &object);
+    Ref<CodeType> TypeFromArrayInitializer(const Parsing::SyntaxNode &object);
+    Ref<CodeValue> FollowDotChain(const Parsing::SyntaxNode &);
+    Ref<CodeType> GenerateGenericType(Parsing::GenericType *generic);
+    std::vector<Ref<CodeType>> ResolveGenericArguments(const Parsing::GenericType &generic);
+    static GenericInstance GenericInstanceKey(SymbolNode *symbol, const std::vector<Ref<CodeType>> &arguments);
 
     void GenerateMain();
+    void Optimize(OptimizationLevel level, llvm::TargetMachine *target = nullptr, bool preLink = false) { Optimize(*module, level, target, preLink); }
+    static void Optimize(llvm::Module &module, OptimizationLevel level, llvm::TargetMachine *target = nullptr, bool preLink = false);
+    void PreCodeGen(const Parsing::FlatTree &tree);
+    void Resolve(SymbolNode *symbol);
+    void ResolveActions(const std::vector<const Parsing::SyntaxNode *> &actions);
+    void GenerateDeferred();
+    void ResolveAll();
+
+    bool OwnsBody(const llvm::Function *function) const
+    {
+        if (partitions <= 1)
+            return true;
+        auto name = function->getName();
+        return std::hash<std::string_view>()(std::string_view(name.data(), name.size())) % partitions == partition;
+    }
+
+    llvm::GlobalVariable *CreateGlobal(llvm::Type *type, bool constant, llvm::Constant *initializer, const std::string &name);
+    std::vector<std::string> ExternalizeGlobals();
+    void InternalizeGlobals(const std::vector<std::string> &names);
+    bool LinkPartition(llvm::StringRef bitcode);
+
+    static std::vector<std::string> HostFeatures();
+    static llvm::CodeGenOpt::Level CodeGenLevel(OptimizationLevel level);
+    static std::unique_ptr<llvm::TargetMachine> CreateHostTargetMachine(OptimizationLevel level);
+    void SetTarget(const llvm::TargetMachine &target);
+    bool EmitFile(llvm::TargetMachine &target, const std::string &filename, llvm::CodeGenFileType type);
+    llvm::orc::ThreadSafeModule TakeModule();
+    void WriteBitcode(llvm::raw_ostream &stream);
 
     // Creates a new scope and sets the insert point for new symbols
     template <IsSymbolNode T, typename... Args>
-    T *NewScope(std::string name, Args... args)
+    T *NewScope(InternId name, Args... args)
     {
         return static_cast<T *>((insertPoint = insertPoint->AddChild<T>(name, args...)));
     }
@@ -566,7 +708,7 @@ public:
     template <IsSymbolNode T, typename... Args>
     T *NewScope()
     {
-        auto name = insertPoint->GenerateName();
+        auto name = Interner::Intern(insertPoint->GenerateName());
         return static_cast<T *>((insertPoint = insertPoint->AddChild<T>(name)));
     }
 
@@ -597,23 +739,35 @@ public:
     }
 
     // Iterate backwards the symbol tree to see if the specified symbol name  exits
-    SymbolNode *FindSymbolInScope(const std::string &name)
+    SymbolNode *FindSymbolInScope(InternId name)
+    {
+        auto symbol = LookupSymbol(name);
+        if (symbol && symbol->IsDeferred())
+            Resolve(symbol);
+        return symbol;
+    }
+
+    // FindSymbolInScope without resolving deferred declarations
+    SymbolNode *LookupSymbol(InternId name)
     {
+        if (insertPoint == nullptr || insertPoint->IsKnownMissing(name))
+            return nullptr;
+
         for (auto look = insertPoint; look != nullptr; look = look->parent)
         {
             auto current = look->findSymbol(name);
             if (current != look->GetChildren().end())
                 return current->second;
         }
+        insertPoint->SetKnownMissing(name);
         return nullptr;
     }
 
     template <IsSymbolNode T>
-    T *FindSymbolInScope(const std::string &name)
+    T *FindSymbolInScope(InternId name)
     {
         if (auto sym = FindSymbolInScope(name))
-            if (auto tsym = dynamic_cast<T *>(sym))
-                return tsym;
+            return dyn_cast<T>(sym);
         return nullptr;
     }
 
@@ -622,11 +776,10 @@ public:
     {
         for (auto look = insertPoint; look != nullptr; look = look->parent)
         {
-            auto current = look->findSymbol(symbol);
-            if (current != "")
-                return current;
+            if (symbol->parent == look)
+                return std::string(symbol->GetName());
         }
-        return nullptr;
+        return "";
     }
 
     // template <IsSymbolNode T>
@@ -643,7 +796,7 @@ public:
         return currentFunction;
     }
 
-    void SetCurrentFunction(std::shared_ptr<FunctionCodeValue> func)
+    void SetCurrentFunction(Ref<FunctionCodeValue> func)
     {
         currentFunction = func;
     }
@@ -653,7 +806,7 @@ public:
         return currentVar;
     }
 
-    void SetCurrentVar(std::shared_ptr<CodeValue> var)
+    void SetCurrentVar(Ref<CodeValue> var)
     {
         currentVar = var;
     }
@@ -663,7 +816,7 @@ public:
         return currentType;
     }
 
-    void SetCurrentType(std::shared_ptr<CodeType> var)
+    void SetCurrentType(Ref<CodeType> var)
     {
         currentType = var;
     }
@@ -673,7 +826,7 @@ public:
         return dotExprBase;
     }
 
-    void SetDotExprBase(std::shared_ptr<CodeValue> var)
+    void SetDotExprBase(Ref<CodeValue> var)
     {
         dotExprBase = var;
     }
@@ -689,29 +842,21 @@ public:
         return TmpB.CreateAlloca(type, nullptr, VarName);
     }
 
-    std::string GenerateMangledName(const std::string &name)
+    std::string GenerateMangledName(std::string_view name)
     {
-        std::string s = std::to_string(name.size()) + name;
-        for (auto p = insertPoint; p != nullptr && p->GetParent() != nullptr;)
-        {
-            std::string nname = p->GetParent()->findSymbol(p);
-            s = std::to_string(nname.size()) + nname + s;
-            p = p->GetParent();
-        }
-        s = "_ZN" + s;
+        std::string s = "_ZN";
+        if (insertPoint != nullptr)
+            s += insertPoint->GetMangledPrefix();
+        s += std::to_string(name.size());
+        s += name;
         return s;
     }
 
-    std::string GenerateMangledTypeName(const std::string &name)
+    std::string GenerateMangledTypeName(std::string_view name)
     {
-        std::string s = name;
-        for (auto p = insertPoint; p != nullptr && p->GetParent() != nullptr;)
-        {
-            std::string nname = p->GetParent()->findSymbol(insertPoint);
-            if (nname != "")
-                s = nname + "." + s;
-            p = p->GetParent();
-        }
+        std::string s(name);
+        if (insertPoint != nullptr && insertPoint->GetParent() != nullptr)
+            s = std::string(insertPoint->GetName()) + "." + s;
         return s;
     }
 
@@ -68,7 +68,8 @@ enum class ErrorCode
     NoReturn,
     NotBoolean,
     NotIntegral,
-    UnkownType
+    UnkownType,
+    Link
 };
 
 class BaseException
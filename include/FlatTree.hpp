@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include <Token.hpp>
+
+namespace Parsing
+{
+    // Flattened view of a syntax tree built in one pass after parsing. Nodes are laid out breadth first so
+    // the children of any node occupy one contiguous index range, and each property lives in its own array.
+    // Walking it touches a few dense arrays instead of making virtual calls on nodes spread over the heap.
+    class FlatTree
+    {
+    public:
+        using Index = uint32_t;
+        static constexpr Index Root = 0;
+
+    private:
+        std::vector<SyntaxType> kinds;
+        std::vector<Index> firstChild;
+        std::vector<uint32_t> childCount;
+        std::vector<const SyntaxNode *> nodes; // Payloads (tokens, literals) stay on the original node
+
+    public:
+        FlatTree(const SyntaxNode &root);
+
+        size_t Size() const { return kinds.size(); }
+
+        SyntaxType Kind(Index node) const { return kinds[node]; }
+        uint32_t NumChildren(Index node) const { return childCount[node]; }
+        Index Child(Index node, int index) const { return firstChild[node] + index; }
+        const SyntaxNode &Node(Index node) const { return *nodes[node]; }
+
+        // Visit every node of a kind in layout order
+        template <typename Fn>
+        void ForEach(SyntaxType kind, Fn fn) const
+        {
+            for (Index i = 0; i < kinds.size(); i++)
+                if (kinds[i] == kind)
+                    fn(i);
+        }
+
+        // Visit the children of a node, a single run over their contiguous range
+        template <typename Fn>
+        void ForEachChild(Index node, Fn fn) const
+        {
+            for (Index i = firstChild[node], end = i + childCount[node]; i < end; i++)
+                fn(i);
+        }
+    };
+} // namespace Parsing
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include <Interner.hpp>
+
+// Open addressing hash map keyed by interned ids. Entries live densely in insertion order and the probe
+// table only holds their positions, so iteration order is deterministic and a lookup touches two arrays.
+template <typename Value>
+class IdMap
+{
+public:
+    using value_type = std::pair<InternId, Value>;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+private:
+    static constexpr uint32_t EmptySlot = UINT32_MAX;
+
+    std::vector<value_type> entries;
+    std::vector<uint32_t> slots; // Entry index or EmptySlot, size is zero or a power of two
+
+public:
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    iterator find(InternId key) { return entries.begin() + IndexOf(key); }
+    const_iterator find(InternId key) const { return entries.begin() + IndexOf(key); }
+
+    // Does nothing if the key is already present, like std::unordered_map::insert
+    std::pair<iterator, bool> insert(const value_type &entry)
+    {
+        auto index = IndexOf(entry.first);
+        if (index != entries.size())
+            return {entries.begin() + index, false};
+
+        if ((entries.size() + 1) * 2 > slots.size())
+            Rehash(slots.empty() ? 8 : slots.size() * 2);
+
+        entries.push_back(entry);
+        Place(entries.size() - 1);
+        return {entries.end() - 1, true};
+    }
+
+    Value &operator[](InternId key)
+    {
+        return insert(value_type(key, Value{})).first->second;
+    }
+
+private:
+    // Ids are handed out sequentially, multiplying by an odd constant spreads neighbours over the table
+    static size_t Hash(InternId key) { return static_cast<uint32_t>(key * 0x9E3779B1u); }
+
+    size_t IndexOf(InternId key) const
+    {
+        if (slots.empty())
+            return entries.size();
+
+        size_t mask = slots.size() - 1;
+        for (size_t i = Hash(key) & mask;; i = (i + 1) & mask)
+        {
+            auto slot = slots[i];
+            if (slot == EmptySlot)
+                return entries.size();
+            if (entries[slot].first == key)
+                return slot;
+        }
+    }
+
+    void Place(size_t index)
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = Hash(entries[index].first) & mask;
+        while (slots[i] != EmptySlot)
+            i = (i + 1) & mask;
+        slots[i] = static_cast<uint32_t>(index);
+    }
+
+    void Rehash(size_t size)
+    {
+        slots.assign(size, EmptySlot);
+        for (size_t i = 0; i < entries.size(); i++)
+            Place(i);
+    }
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+using InternId = uint32_t;
+
+// Id of no name, what tokens that aren't identifiers and unnamed symbols carry. Never handed out for a real string
+constexpr InternId InvalidInternId = 0;
+
+// Global table giving every distinct name a stable id so names can be hashed and compared as integers. Shared by
+// the threads generating a module's partitions, so access is guarded
+class Interner
+{
+public:
+    static InternId Intern(std::string_view str);
+    static std::string_view Get(InternId id);
+
+private:
+    Interner();
+
+    static Interner &Instance();
+
+private:
+    std::deque<std::string> strings; // Deque so views of existing strings stay valid as it grows
+    std::unordered_map<std::string_view, InternId> ids;
+    std::shared_mutex mutex;
+};
@@ -3,14 +3,27 @@
 #include <CodeGen.hpp>
 #include <Tokenizer.hpp>
 
+#include <llvm/ADT/SmallVector.h>
+
 #include <string>
+#include <vector>
 
 using namespace Parsing;
 
+// What Emit writes
+enum class OutputKind
+{
+    IR,
+    Bitcode, // With a ThinLTO summary, optimized with the pre link pipeline
+    Assembly,
+    Object,
+    Executable
+};
+
 class ModuleUnit
 {
 public:
-    static ErrorList errors;
+    static thread_local ErrorList errors; // Each partition thread collects its own, see GeneratePartition
 
 private:
     static FileIterator *globalFptr;
@@ -21,16 +34,49 @@ private:
 
     FileIterator fptr;
 
+    Arena syntaxArena; // Backs the syntax tree, released with the module
+
     std::unique_ptr<Tokenizer> tokenizer;
     std::unique_ptr<Parser> parser;
     std::unique_ptr<CodeGeneration> generation;
 
+    unsigned jobs = 1; // Threads function bodies are generated on
+    OptimizationLevel optimization = OptimizationLevel::O0;
+    uint32_t tierThreshold = 0; // Calls before Run optimizes a function, 0 optimizes everything up front
+
+    OutputKind output = OutputKind::IR;
+    std::string outputPath; // Defaults to out and the kind's extension
+    std::unique_ptr<llvm::TargetMachine> target; // Host target, code is generated and optimized for it
+
+    // What a worker thread hands back for one partition of the function bodies
+    struct Partition
+    {
+        llvm::SmallVector<char, 0> bitcode; // Empty if generation was aborted
+        std::vector<BaseException *> errors;
+    };
+
 public:
     ModuleUnit(const std::string &filename, const std::string &moduleName);
     ~ModuleUnit();
 
     void Compile();
-    void DumpIR();
+    bool Emit();
+    bool WriteBitcode(llvm::raw_ostream &stream);
+    int Run();
+    void DumpIR(const std::string &filename = "out.ll");
+
+    void SetJobs(unsigned jobs) { this->jobs = jobs > 0 ? jobs : 1; }
+    void SetOptimizationLevel(OptimizationLevel level) { optimization = level; }
+    void SetTierThreshold(uint32_t calls) { tierThreshold = calls; }
+    void SetOutput(OutputKind kind) { output = kind; }
+    void SetOutputPath(const std::string &path) { outputPath = path; }
     
     static FileIterator &GetFptr() { return *globalFptr; }
+    static bool LinkObjects(const std::vector<std::string> &objectFiles, const std::string &executable);
+
+private:
+    static void GenerateBodies(CodeGeneration &generation, const SyntaxNode &syntaxTree);
+    void GeneratePartitions(const SyntaxNode &syntaxTree, const FlatTree &flatTree);
+    void GeneratePartition(const SyntaxNode &syntaxTree, const FlatTree &flatTree, unsigned index, Partition &partition);
+    bool Link(const std::string &executable);
 };
\ No newline at end of file
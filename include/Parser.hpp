@@ -11,6 +11,8 @@
 #include <Token.hpp>
 #include <Trie.hpp>
 #include <Errors.hpp>
+#include <Arena.hpp>
+#include <FlatTree.hpp>
 #include <CodeGen.hpp>
 
 #include <llvm/IR/Value.h>
@@ -39,6 +41,9 @@ namespace Parsing
 
     class TypeExpression : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::TypeExpression;
+
     private:
         TypeSyntax *type;
 
@@ -48,7 +53,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::TypeExpression; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 1;
         }
@@ -71,6 +76,9 @@ namespace Parsing
 
     class PrimitiveType : public TypeSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::PrimitiveType;
+
     private:
         const Token &token;
 
@@ -80,7 +88,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::PrimitiveType; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 0;
         }
@@ -105,6 +113,9 @@ namespace Parsing
 
     class IdentifierType : public TypeSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::IdentifierType;
+
     private:
         const Token &token;
 
@@ -114,7 +125,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::IdentifierType; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 0;
         }
@@ -139,6 +150,9 @@ namespace Parsing
 
     class ArrayType : public TypeSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::ArrayType;
+
     private:
         const Token &open;
         TypeSyntax *type;
@@ -159,7 +173,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::ArrayType; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 1 + (colon == TokenNull ? 0 : 1);
         }
@@ -195,23 +209,26 @@ namespace Parsing
 
     class FunctionType : public TypeSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::FunctionType;
+
         const Token &left;
-        std::vector<TypeSyntax *> parameters;
+        ArenaVector<TypeSyntax *> parameters;
         const Token &right;
         const Token &arrow;
         TypeSyntax *retType;
 
     public:
         FunctionType(const Token &left,
-                     const std::vector<TypeSyntax *> &parameters,
+                     ArenaVector<TypeSyntax *> parameters,
                      const Token &right,
                      const Token &arrow,
-                     TypeSyntax *retType) : left{left}, parameters{parameters}, right{right}, arrow{arrow}, retType{retType} {}
+                     TypeSyntax *retType) : left{left}, parameters{std::move(parameters)}, right{right}, arrow{arrow}, retType{retType} {}
         virtual ~FunctionType() {}
 
         virtual const SyntaxType GetType() const override { return SyntaxType::FunctionType; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return parameters.size() + (retType != nullptr ? 1 : 0);
         }
@@ -243,6 +260,9 @@ namespace Parsing
 
     class ReferenceType : public TypeSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::ReferenceType;
+
     private:
         const Token &token;
         TypeSyntax *type;
@@ -253,7 +273,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::ReferenceType; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 1;
         }
@@ -279,22 +299,25 @@ namespace Parsing
 
     class GenericType : public TypeSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::GenericType;
+
     private:
         TypeSyntax *type;
         const Token &left;
-        std::vector<TypeSyntax *> arguments;
+        ArenaVector<TypeSyntax *> arguments;
         const Token &right;
 
     public:
         GenericType(TypeSyntax *type,
                     const Token &left,
-                    const std::vector<TypeSyntax *> &arguments,
-                    const Token &right) : type{type}, left{left}, arguments{arguments}, right{right} {}
+                    ArenaVector<TypeSyntax *> arguments,
+                    const Token &right) : type{type}, left{left}, arguments{std::move(arguments)}, right{right} {}
         virtual ~GenericType() {}
 
         virtual const SyntaxType GetType() const override { return SyntaxType::GenericType; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return arguments.size() + 1;
         }
@@ -326,6 +349,9 @@ namespace Parsing
 
     class IntegerSyntax : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::Integer;
+
     private:
         const Token &valueToken;
 
@@ -338,14 +364,14 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::Integer; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 0;
         }
 
         virtual const SyntaxNode &operator[](int index) const override
         {
-            return valueToken;
+            return *this;
         }
 
         virtual const Position &GetStart() const override
@@ -358,14 +384,17 @@ namespace Parsing
             return valueToken.GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const uint64_t GetValue() const { return valueToken.ivalue; }
-        const std::string &GetRawValue() const { return valueToken.raw; }
+        std::string_view GetRawValue() const { return valueToken.raw; }
     };
 
     class FloatingSyntax : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::Floating;
+
     private:
         const Token &valueToken;
 
@@ -378,14 +407,14 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::Floating; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 0;
         }
 
         virtual const SyntaxNode &operator[](int index) const override
         {
-            return valueToken;
+            return *this;
         }
 
         virtual const Position &GetStart() const override
@@ -398,14 +427,17 @@ namespace Parsing
             return valueToken.GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const double GetValue() const { return valueToken.fvalue; }
-        const std::string &GetRawValue() const { return valueToken.raw; }
+        std::string_view GetRawValue() const { return valueToken.raw; }
     };
 
     class BooleanSyntax : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::Boolean;
+
     private:
         const Token &boolToken;
         bool value;
@@ -419,14 +451,14 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::Boolean; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 0;
         }
 
         virtual const SyntaxNode &operator[](int index) const override
         {
-            return boolToken;
+            return *this;
         }
 
         virtual const Position &GetStart() const override
@@ -439,7 +471,7 @@ namespace Parsing
             return boolToken.GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetBoolToken() const { return boolToken; }
         const auto &GetValue() const { return value; }
@@ -447,6 +479,9 @@ namespace Parsing
 
     class StringSyntax : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::String;
+
     private:
         const Token &token;
 
@@ -459,7 +494,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::String; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 0;
         }
@@ -479,7 +514,7 @@ namespace Parsing
             return token.GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetToken() const { return token; }
         const auto &GetValue() const { return token.raw; }
@@ -487,6 +522,9 @@ namespace Parsing
     
     class CharSyntax : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::Char;
+
     private:
         const Token &token;
 
@@ -499,7 +537,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::Char; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 0;
         }
@@ -519,7 +557,7 @@ namespace Parsing
             return token.GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetToken() const { return token; }
         const auto &GetValue() const { return token.raw; }
@@ -527,6 +565,9 @@ namespace Parsing
 
     class ObjectKeyValue : public SyntaxNode
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::ObjectKeyValue;
+
     private:
         const Token &key;
         const Token &colon;
@@ -540,7 +581,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::ObjectKeyValue; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 1;
         }
@@ -567,22 +608,25 @@ namespace Parsing
 
     class ObjectInitializer : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::ObjectInitializer;
+
     private:
         const Token &left;
-        std::vector<ObjectKeyValue *> values;
+        ArenaVector<ObjectKeyValue *> values;
         const Token &right;
 
     public:
         ObjectInitializer(const Token &left,
-                          std::vector<ObjectKeyValue *> values,
-                          const Token &right) : left{left}, values{values}, right{right}
+                          ArenaVector<ObjectKeyValue *> values,
+                          const Token &right) : left{left}, values{std::move(values)}, right{right}
         {
         }
         virtual ~ObjectInitializer() {}
 
         virtual const SyntaxType GetType() const override { return SyntaxType::ObjectInitializer; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return values.size();
         }
@@ -602,7 +646,7 @@ namespace Parsing
             return right.GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetLeft() const { return left; }
         const auto &GetValues() const { return values; }
@@ -611,6 +655,9 @@ namespace Parsing
 
     class TemplateInitializer : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::TemplateInitializer;
+
     private:
         TypeSyntax *type;
         ObjectInitializer *body;
@@ -623,7 +670,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::TemplateInitializer; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return (type == nullptr ? 0 : 1) + (body == nullptr ? 0 : 1);
         }
@@ -650,7 +697,7 @@ namespace Parsing
             return body->GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetTemplateType() const { return *type; }
         const auto &GetBody() const { return *body; }
@@ -666,6 +713,9 @@ namespace Parsing
 
     class ArrayLiteralExpressionEntry : public ArrayLiteralEntry
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::ArrayLiteralExpressionEntry;
+
     private:
         Expression expression;
 
@@ -677,7 +727,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::ArrayLiteralExpressionEntry; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 1;
         }
@@ -697,13 +747,16 @@ namespace Parsing
             return expression->GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override { return expression->CodeGen(gen); }
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override { return expression->CodeGen(gen); }
 
         const ExpressionSyntax &GetExpression() const override { return *expression; }
     };
 
     class ArrayLiteralBoundaryEntry : public ArrayLiteralEntry
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::ArrayLiteralBoundaryEntry;
+
     private:
         Expression expression;
         const Token &colon;
@@ -719,7 +772,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::ArrayLiteralBoundaryEntry; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 2;
         }
@@ -754,7 +807,7 @@ namespace Parsing
                 return 0;
         };
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override { return expression->CodeGen(gen); }
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override { return expression->CodeGen(gen); }
 
         const ExpressionSyntax &GetExpression() const override { return *expression; }
         const auto &GetColon() const { return colon; }
@@ -763,20 +816,23 @@ namespace Parsing
 
     class ArrayLiteral : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::ArrayLiteral;
+
     private:
         const Token &left;
-        std::vector<ArrayLiteralEntry *> values;
+        ArenaVector<ArrayLiteralEntry *> values;
         const Token &right;
 
     public:
-        ArrayLiteral(const Token &left, const std::vector<ArrayLiteralEntry *> &values, const Token &right) : left{left}, values{values}, right{right}
+        ArrayLiteral(const Token &left, ArenaVector<ArrayLiteralEntry *> values, const Token &right) : left{left}, values{std::move(values)}, right{right}
         {
         }
         virtual ~ArrayLiteral() {}
 
         virtual const SyntaxType GetType() const override { return SyntaxType::ArrayLiteral; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return values.size();
         }
@@ -796,7 +852,7 @@ namespace Parsing
             return right.GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetLeft() const { return left; }
         const auto &GetValues() const { return values; }
@@ -805,6 +861,9 @@ namespace Parsing
 
     class BinaryExpression : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::BinaryExpression;
+
     private:
         Expression LHS;
         Expression RHS;
@@ -818,7 +877,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::BinaryExpression; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 2;
         }
@@ -845,7 +904,7 @@ namespace Parsing
             return RHS->GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetLHS() const { return *LHS; }
         const auto &GetRHS() const { return *RHS; }
@@ -854,6 +913,9 @@ namespace Parsing
 
     class UnaryExpression : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::UnaryExpression;
+
     private:
         Expression expression;
         const Token &op;
@@ -866,7 +928,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::UnaryExpression; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 1;
         }
@@ -891,7 +953,7 @@ namespace Parsing
             return expression->GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetExpression() const { return *expression; }
         const auto &GetOperator() const { return op; }
@@ -899,6 +961,9 @@ namespace Parsing
 
     class PostfixExpression : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::PostfixExpression;
+
     private:
         Expression expression;
         const Token &op;
@@ -911,7 +976,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::PostfixExpression; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 1;
         }
@@ -936,7 +1001,7 @@ namespace Parsing
             return expression->GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetExpression() const { return *expression; }
         const auto &GetOperator() const { return op; }
@@ -944,6 +1009,9 @@ namespace Parsing
 
     class IdentifierExpression : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::IdentifierExpression;
+
     private:
         const Token &identifierToken;
 
@@ -953,7 +1021,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::IdentifierExpression; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 0;
         }
@@ -973,29 +1041,32 @@ namespace Parsing
             return identifierToken.GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetIdentiferToken() const { return identifierToken; }
     };
 
     class CallExpression : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::CallExpression;
+
     private:
         Expression fn;
         const Token &leftParen;
-        std::vector<Expression> arguments;
+        ArenaVector<Expression> arguments;
         const Token &rightParen;
 
     public:
         CallExpression(Expression fn, const Token &leftParen,
-                       const Token &rightParen, std::vector<Expression> arguments) : fn{fn}, leftParen{leftParen}, rightParen{rightParen}, arguments{arguments}
+                       const Token &rightParen, ArenaVector<Expression> arguments) : fn{fn}, leftParen{leftParen}, rightParen{rightParen}, arguments{std::move(arguments)}
         {
         }
         virtual ~CallExpression() {}
 
         virtual const SyntaxType GetType() const override { return SyntaxType::CallExpression; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return arguments.size() + 1;
         }
@@ -1021,7 +1092,7 @@ namespace Parsing
             return rightParen.GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetFunctionExpression() const { return *fn; }
         const auto &GetFunctionArgs() const { return arguments; }
@@ -1029,6 +1100,9 @@ namespace Parsing
 
     class SubscriptExpression : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::SubscriptExpression;
+
     private:
         Expression expr;
         const Token &left;
@@ -1046,7 +1120,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::SubscriptExpression; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 2;
         }
@@ -1072,7 +1146,7 @@ namespace Parsing
             return right.GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetExpression() const { return *expr; }
         const auto &GetLeft() const { return left; }
@@ -1082,6 +1156,9 @@ namespace Parsing
 
     class CastExpression : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::CastExpression;
+
     private:
         Expression LHS;
         const Token &keyword;
@@ -1097,7 +1174,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::CastExpression; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 2;
         }
@@ -1123,7 +1200,7 @@ namespace Parsing
             return type->GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetExpression() const { return *LHS; }
         const auto &GetKeyword() const { return keyword; }
@@ -1150,17 +1227,20 @@ namespace Parsing
 
     class GenericParameterEntry : public SyntaxNode
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::GenericParameterEntry;
+
     private:
         const Token &identifier;
-        std::vector<TypeSyntax *> constraints;
+        ArenaVector<TypeSyntax *> constraints;
 
     public:
-        GenericParameterEntry(const Token &identifier, const std::vector<TypeSyntax *> &constraints) : identifier{identifier}, constraints{constraints} {}
+        GenericParameterEntry(const Token &identifier, ArenaVector<TypeSyntax *> constraints) : identifier{identifier}, constraints{std::move(constraints)} {}
         virtual ~GenericParameterEntry() {}
 
         virtual const SyntaxType GetType() const override { return SyntaxType::GenericParameterEntry; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return constraints.size();
         }
@@ -1186,21 +1266,24 @@ namespace Parsing
 
     class GenericParameter : public SyntaxNode
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::GenericParameter;
+
 
     private:
         const Token &left;
-        std::vector<GenericParameterEntry *> parameters;
+        ArenaVector<GenericParameterEntry *> parameters;
         const Token &right;
 
     public:
         GenericParameter(const Token &left,
-                         const std::vector<GenericParameterEntry *> &parameters,
-                         const Token &right) : left{left}, parameters{parameters}, right{right} {}
+                         ArenaVector<GenericParameterEntry *> parameters,
+                         const Token &right) : left{left}, parameters{std::move(parameters)}, right{right} {}
         virtual ~GenericParameter() {}
 
         virtual const SyntaxType GetType() const override { return SyntaxType::GenericParameter; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return parameters.size();
         }
@@ -1227,6 +1310,9 @@ namespace Parsing
 
     class ExpressionBodyStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::ExpressionBodyStatement;
+
     private:
         const Token &getArrow;
         Statement get;
@@ -1247,7 +1333,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::ExpressionBodyStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return (get == nullptr ? 0 : 1) + (set == nullptr ? 0 : 1);
         }
@@ -1291,6 +1377,9 @@ namespace Parsing
 
     class ExpressionBodySpecStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::ExpressionBodySpecStatement;
+
     private:
         const Token &left;
         const Token &get;
@@ -1308,14 +1397,14 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::ExpressionBodySpecStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 0;
         }
 
         virtual const SyntaxNode &operator[](int index) const override
         {
-            return get;
+            return *this;
         }
 
         virtual const Position &GetStart() const override
@@ -1336,26 +1425,47 @@ namespace Parsing
         const bool HasSet() const { return hasSet; }
     };
 
+    class EnumIdentifierStatement;
+    class MatchEntry;
+
+    // Each kind of block has a kind of its own so isa/dyn_cast can't take one for another
+    template <IsSyntaxNode T>
+    constexpr SyntaxType BlockKind()
+    {
+        if constexpr (std::is_same_v<T, EnumIdentifierStatement>)
+            return SyntaxType::EnumBlockStatement;
+        else if constexpr (std::is_same_v<T, MatchEntry>)
+            return SyntaxType::MatchBlockStatement;
+        else
+        {
+            static_assert(std::is_same_v<T, StatementSyntax>, "BlockStatement of this element type needs a kind");
+            return SyntaxType::BlockStatement;
+        }
+    }
+
     template <IsSyntaxNode T = StatementSyntax>
     class BlockStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = BlockKind<T>();
+
     private:
         using PT = T *;
 
     private:
         const Token &open;
-        std::vector<PT> statements;
+        ArenaVector<PT> statements;
         const Token &close;
 
     public:
         BlockStatement(const Token &open,
-                       const std::vector<PT> &statements,
-                       const Token &close) : open{open}, statements{statements}, close{close} {}
+                       ArenaVector<PT> statements,
+                       const Token &close) : open{open}, statements{std::move(statements)}, close{close} {}
         virtual ~BlockStatement() {}
 
-        virtual const SyntaxType GetType() const override { return SyntaxType::BlockStatement; }
+        virtual const SyntaxType GetType() const override { return Kind; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return statements.size();
         }
@@ -1375,7 +1485,7 @@ namespace Parsing
             return close.GetStart();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override
         {
             bool used = gen.IsUsed(CodeGeneration::Using::NoBlock);
             if (used)
@@ -1383,7 +1493,7 @@ namespace Parsing
             else
                 gen.NewScope<ScopeNode>();
 
-            std::shared_ptr<CodeValue> ret;
+            Ref<CodeValue> ret;
             for (auto s : statements)
             {
                 ret = s->CodeGen(gen);
@@ -1411,6 +1521,9 @@ namespace Parsing
 
     class TemplateStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::TemplateStatement;
+
     private:
         const Token &keyword;
         const Token &identifier;
@@ -1424,14 +1537,12 @@ namespace Parsing
         TemplateStatement(const Token &keyword,
                           const Token &identifier,
                           GenericParameter *generic,
-                          const Token &open,
-                          const std::vector<Statement> &statements,
-                          const Token &close) : keyword{keyword}, identifier{identifier}, generic{generic}, body{new BlockStatement(open, statements, close)} {}
+                          BlockStatement<> *body) : keyword{keyword}, identifier{identifier}, generic{generic}, body{body} {}
         virtual ~TemplateStatement() {}
 
         virtual const SyntaxType GetType() const override { return SyntaxType::TemplateStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 1 + (generic == nullptr ? 0 : 1);
         }
@@ -1461,7 +1572,7 @@ namespace Parsing
             return body->GetStart();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
         virtual void PreCodeGen(CodeGeneration &gen) const override;
 
         const auto &GetKeyword() const { return keyword; }
@@ -1472,6 +1583,9 @@ namespace Parsing
 
     class SpecStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::SpecStatement;
+
     private:
         const Token &keyword;
         const Token &identifier;
@@ -1485,14 +1599,12 @@ namespace Parsing
         SpecStatement(const Token &keyword,
                       const Token &identifier,
                       GenericParameter *generic,
-                      const Token &open,
-                      const std::vector<Statement> &statements,
-                      const Token &close) : keyword{keyword}, identifier{identifier}, generic{generic}, body{new BlockStatement(open, statements, close)} {}
+                      BlockStatement<> *body) : keyword{keyword}, identifier{identifier}, generic{generic}, body{body} {}
         virtual ~SpecStatement() {}
 
         virtual const SyntaxType GetType() const override { return SyntaxType::SpecStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 1 + generic == nullptr ? 0 : 1;
         }
@@ -1522,7 +1634,7 @@ namespace Parsing
             return body->GetStart();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
         virtual void PreCodeGen(CodeGeneration &gen) const override;
 
         const auto &GetKeyword() const { return keyword; }
@@ -1533,6 +1645,9 @@ namespace Parsing
 
     class ExpressionStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::ExpressionStatement;
+
     private:
         Expression expression;
 
@@ -1542,7 +1657,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::ExpressionStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 1;
         }
@@ -1562,7 +1677,7 @@ namespace Parsing
             return expression->GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override
         {
             return expression->CodeGen(gen);
         }
@@ -1570,6 +1685,9 @@ namespace Parsing
 
     class VariableDeclerationStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::VariableDeclerationStatement;
+
     private:
         const Token &keyword;
         const Token &identifier;
@@ -1595,7 +1713,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::VariableDeclerationStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return (type == nullptr ? 0 : 1) + (initializer == nullptr ? 0 : 1) + (expressionBody == nullptr ? 0 : 1) + (specExpressionBody == nullptr ? 0 : 1);
         }
@@ -1638,7 +1756,7 @@ namespace Parsing
                 return identifier.position.end;
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetKeyword() const { return keyword; }
         const auto &GetIdentifier() const { return identifier; }
@@ -1651,12 +1769,15 @@ namespace Parsing
 
     class FunctionDeclerationStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::FunctionDeclerationStatement;
+
     private:
         const Token &keyword;
         const Token &identifier;
         GenericParameter *generic;
         const Token &left;
-        std::vector<VariableDeclerationStatement *> parameters;
+        ArenaVector<VariableDeclerationStatement *> parameters;
         const Token &right;
         const Token &arrow;
         TypeSyntax *retType;
@@ -1667,16 +1788,16 @@ namespace Parsing
                                      const Token &identifier,
                                      GenericParameter *generic,
                                      const Token &left,
-                                     const std::vector<VariableDeclerationStatement *> &parameters,
+                                     ArenaVector<VariableDeclerationStatement *> parameters,
                                      const Token &right,
                                      const Token &arrow = TokenNull,
                                      TypeSyntax *retType = nullptr,
-                                     Statement body = nullptr) : keyword{keyword}, identifier{identifier}, generic{generic}, left{left}, parameters{parameters}, right{right}, arrow{arrow}, retType{retType}, body{body} {}
+                                     Statement body = nullptr) : keyword{keyword}, identifier{identifier}, generic{generic}, left{left}, parameters{std::move(parameters)}, right{right}, arrow{arrow}, retType{retType}, body{body} {}
         virtual ~FunctionDeclerationStatement() {}
 
         virtual const SyntaxType GetType() const override { return SyntaxType::FunctionDeclerationStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return parameters.size() + (body == nullptr ? 0 : 1) + (retType == nullptr ? 0 : 1) + (generic == nullptr ? 0 : 1);
         }
@@ -1716,7 +1837,7 @@ namespace Parsing
                 return arrow.position.end;
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
         virtual void PreCodeGen(CodeGeneration &gen) const override;
 
         const auto &GetKeyword() const { return keyword; }
@@ -1733,9 +1854,12 @@ namespace Parsing
 
     class AnonymousFunctionExpression : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::AnonymousFunctionExpression;
+
     private:
         const Token &left;
-        std::vector<VariableDeclerationStatement *> parameters;
+        ArenaVector<VariableDeclerationStatement *> parameters;
         const Token &right;
         const Token &arrow;
         TypeSyntax *retType;
@@ -1743,18 +1867,18 @@ namespace Parsing
 
     public:
         AnonymousFunctionExpression(const Token &left,
-                                    std::vector<VariableDeclerationStatement *> parameters,
+                                    ArenaVector<VariableDeclerationStatement *> parameters,
                                     const Token &right,
                                     const Token &arrow,
                                     TypeSyntax *retType,
-                                    Statement body) : left{left}, parameters{parameters}, right{right}, arrow{arrow}, retType{retType}, body{body}
+                                    Statement body) : left{left}, parameters{std::move(parameters)}, right{right}, arrow{arrow}, retType{retType}, body{body}
         {
         }
         virtual ~AnonymousFunctionExpression() {}
 
         virtual const SyntaxType GetType() const override { return SyntaxType::AnonymousFunctionExpression; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return parameters.size() + (body == nullptr ? 0 : 1) + (retType == nullptr ? 0 : 1);
         }
@@ -1796,6 +1920,9 @@ namespace Parsing
 
     class ElseStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::ElseStatement;
+
     private:
         const Token &keyword;
         Statement body;
@@ -1809,7 +1936,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::ElseStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 1;
         }
@@ -1829,7 +1956,7 @@ namespace Parsing
             return body->GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override
         {
             return body->CodeGen(gen);
         }
@@ -1840,6 +1967,9 @@ namespace Parsing
 
     class IfStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::IfStatement;
+
     private:
         const Token &keyword;
         Expression expression;
@@ -1855,7 +1985,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::IfStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 2 + (elseClause == nullptr ? 0 : 1);
         }
@@ -1885,7 +2015,7 @@ namespace Parsing
             return body->GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetKeyword() const { return keyword; }
         const auto &GetExpression() const { return *expression; }
@@ -1895,6 +2025,9 @@ namespace Parsing
 
     class LoopStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::LoopStatement;
+
     private:
         const Token &keyword;
         Expression expression;
@@ -1908,7 +2041,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::LoopStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 1 + (expression == nullptr ? 0 : 1);
         }
@@ -1938,7 +2071,7 @@ namespace Parsing
             return body->GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetKeyword() const { return keyword; }
         const auto &GetExpression() const { return *expression; }
@@ -1947,6 +2080,9 @@ namespace Parsing
 
     class ReturnStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::ReturnStatement;
+
     private:
         const Token &keyword;
         Expression expression;
@@ -1958,7 +2094,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::ReturnStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return expression == nullptr ? 0 : 1;
         }
@@ -1978,7 +2114,7 @@ namespace Parsing
             return expression->GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetKeyword() const { return keyword; }
         const auto &GetExpression() const { return *expression; }
@@ -1986,6 +2122,9 @@ namespace Parsing
 
     class YieldStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::YieldStatement;
+
     private:
         const Token &keyword;
         Expression expression;
@@ -1997,7 +2136,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::YieldStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 1;
         }
@@ -2023,6 +2162,9 @@ namespace Parsing
 
     class ActionBaseStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::ActionBaseStatement;
+
     private:
         const Token &keyword;
         TypeSyntax *templateType;
@@ -2036,7 +2178,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::ActionBaseStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 2;
         }
@@ -2063,7 +2205,7 @@ namespace Parsing
             return body->GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
         virtual void PreCodeGen(CodeGeneration &gen) const override;
         const auto &GetKeyword() const { return keyword; }
         const auto &GetTemplateType() const { return *templateType; }
@@ -2072,6 +2214,9 @@ namespace Parsing
 
     class ActionSpecStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::ActionSpecStatement;
+
     private:
         const Token &keyword;
         TypeSyntax *specType;
@@ -2089,7 +2234,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::ActionSpecStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 3;
         }
@@ -2118,7 +2263,7 @@ namespace Parsing
             return body->GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
         virtual void PreCodeGen(CodeGeneration &gen) const override;
 
         const auto &GetKeyword() const { return keyword; }
@@ -2130,6 +2275,9 @@ namespace Parsing
 
     class EnumIdentifierStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::EnumIdentifierStatement;
+
     private:
         const Token &identifier;
 
@@ -2139,7 +2287,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::EnumIdentifierStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 0;
         }
@@ -2164,6 +2312,9 @@ namespace Parsing
 
     class EnumStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::EnumStatement;
+
     private:
         const Token &keyword;
         const Token &identifier;
@@ -2173,16 +2324,11 @@ namespace Parsing
         EnumStatement(const Token &keyword,
                       const Token &identifier,
                       BlockStatement<EnumIdentifierStatement> *body) : keyword{keyword}, identifier{identifier}, body{body} {}
-        EnumStatement(const Token &keyword,
-                      const Token &identifier,
-                      const Token &left,
-                      const std::vector<EnumIdentifierStatement *> &statements,
-                      const Token &right) : keyword{keyword}, identifier{identifier}, body{new BlockStatement<EnumIdentifierStatement>(left, statements, right)} {}
         virtual ~EnumStatement() {}
 
         virtual const SyntaxType GetType() const override { return SyntaxType::EnumStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 1;
         }
@@ -2209,6 +2355,9 @@ namespace Parsing
 
     class TypeAliasStatement : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::TypeAliasStatement;
+
     private:
         const Token &keyword;
         const Token &identifier;
@@ -2229,7 +2378,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::TypeAliasStatement; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return (generic == nullptr ? 0 : 1) + (type == nullptr ? 0 : 1);
         }
@@ -2274,6 +2423,9 @@ namespace Parsing
 
     class MatchEntry : public SyntaxNode
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::MatchEntry;
+
     private:
         Expression expr;
         const Token &arrow;
@@ -2289,7 +2441,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::MatchEntry; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return expr == nullptr ? 1 : 2;
         }
@@ -2324,6 +2476,9 @@ namespace Parsing
 
     class MatchExpression : public ExpressionSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::MatchExpression;
+
     private:
         const Token &keyword;
         Expression expr;
@@ -2339,7 +2494,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::MatchExpression; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 2;
         }
@@ -2372,6 +2527,9 @@ namespace Parsing
 
     class ExportDecleration : public StatementSyntax
     {
+    public:
+        static constexpr SyntaxType Kind = SyntaxType::ExportDecleration;
+
     private:
         const Token &keyword;
         Statement statement;
@@ -2385,7 +2543,7 @@ namespace Parsing
 
         virtual const SyntaxType GetType() const override { return SyntaxType::ExportDecleration; }
 
-        virtual const uint8_t NumChildren() const override
+        virtual const uint32_t NumChildren() const override
         {
             return 1;
         }
@@ -2405,7 +2563,7 @@ namespace Parsing
             return statement->GetEnd();
         }
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const override;
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const override;
 
         const auto &GetKeyword() const { return keyword; }
         const auto &GetStatement() const { return *statement; }
@@ -2422,17 +2580,18 @@ namespace Parsing
     private:
         TokenList &tokenList;
         TokenList::iterator tokenIterator;
+        Arena &arena; // Owns every node of the tree
         bool keepGoing = true;
         std::bitset<64> usings;
 
     public:
-        Parser(TokenList &tokenList) : tokenList{tokenList} {}
+        Parser(TokenList &tokenList, Arena &arena) : tokenList{tokenList}, arena{arena} {}
         ~Parser() {}
 
         const Token &Next() { return *(tokenIterator++); }
 
         // std::unique_ptr<ModuleUnit> ParseModule(const std::string &moduleName);
-        std::unique_ptr<BlockStatement<>> Parse();
+        BlockStatement<> *Parse();
 
         Statement ParseStatement();
         Statement ParseTopLevelScopeStatement();
@@ -2486,8 +2645,8 @@ namespace Parsing
         uint8_t BinaryPrecedence(TokenType type);
         bool IsBinaryRightAssociative(TokenType type);
         const Token &Expect(TokenType type);
-        void PrintNode(const SyntaxNode &node, int index = 0, const std::wstring &indent = L"", bool last = false);
-        void RecurseNode(const SyntaxNode &node);
+        void PrintNode(const FlatTree &tree, FlatTree::Index node = FlatTree::Root, int index = 0, const std::wstring &indent = L"", bool last = false);
+        void RecurseNode(const FlatTree &tree, FlatTree::Index node = FlatTree::Root);
 
         void Use(Using toUse) { usings.set((uint64_t)toUse); }
         bool IsUsed(Using toUse) { return usings.test((uint64_t)toUse); }
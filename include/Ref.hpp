@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+template <typename T>
+class Ref;
+
+// Base for objects shared through Ref. The count lives in the object so sharing needs no separate control
+// block, and it is a plain integer since each CodeGeneration and everything it refers to stays on one thread.
+class RefCounted
+{
+    template <typename T>
+    friend class Ref;
+
+private:
+    uint32_t refCount = 0;
+
+protected:
+    RefCounted() = default;
+    RefCounted(const RefCounted &) {} // A copy is a new object with no owners yet
+    RefCounted &operator=(const RefCounted &) { return *this; }
+    ~RefCounted() = default;
+};
+
+// Intrusive reference counted pointer with the parts of the std::shared_ptr interface codegen uses
+template <typename T>
+class Ref
+{
+    template <typename U>
+    friend class Ref;
+
+private:
+    T *ptr = nullptr;
+
+public:
+    Ref() = default;
+    Ref(std::nullptr_t) {}
+    explicit Ref(T *ptr) : ptr{ptr} { Retain(); }
+    Ref(const Ref &other) : ptr{other.ptr} { Retain(); }
+    Ref(Ref &&other) noexcept : ptr{other.ptr} { other.ptr = nullptr; }
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+    Ref(const Ref<U> &other) : ptr{other.ptr} { Retain(); }
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+    Ref(Ref<U> &&other) noexcept : ptr{other.ptr} { other.ptr = nullptr; }
+
+    ~Ref() { Release(); }
+
+    Ref &operator=(Ref other) noexcept
+    {
+        std::swap(ptr, other.ptr);
+        return *this;
+    }
+
+    T *get() const { return ptr; }
+    T &operator*() const { return *ptr; }
+    T *operator->() const { return ptr; }
+    explicit operator bool() const { return ptr != nullptr; }
+
+    void reset()
+    {
+        Release();
+        ptr = nullptr;
+    }
+
+    template <typename U>
+    bool operator==(const Ref<U> &other) const { return ptr == other.ptr; }
+    template <typename U>
+    bool operator!=(const Ref<U> &other) const { return ptr != other.ptr; }
+    bool operator==(std::nullptr_t) const { return ptr == nullptr; }
+    bool operator!=(std::nullptr_t) const { return ptr != nullptr; }
+
+private:
+    void Retain()
+    {
+        if (ptr)
+            ptr->refCount++;
+    }
+
+    void Release()
+    {
+        if (ptr && --ptr->refCount == 0)
+            delete ptr;
+    }
+};
+
+template <typename T, typename... Args>
+Ref<T> MakeRef(Args &&...args)
+{
+    return Ref<T>(new T(std::forward<Args>(args)...));
+}
+
+template <typename T, typename U>
+Ref<T> StaticRefCast(const Ref<U> &ref)
+{
+    return Ref<T>(static_cast<T *>(ref.get()));
+}
+
+template <typename T, typename U>
+Ref<T> DynamicRefCast(const Ref<U> &ref)
+{
+    return Ref<T>(dynamic_cast<T *>(ref.get()));
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Byte scanning kernels used by the tokenizer. Every scan stops at a '\0' so the
+// zero filled tail of the source buffer always terminates it.
+namespace Scan
+{
+#if defined(__AVX2__)
+    using Chunk = __m256i;
+    constexpr uintptr_t ChunkSize = 32;
+    constexpr uint32_t FullMask = 0xFFFFFFFF;
+
+    inline Chunk Load(const char *p) { return _mm256_load_si256(reinterpret_cast<const Chunk *>(p)); }
+    inline Chunk Splat(char c) { return _mm256_set1_epi8(c); }
+    inline Chunk Equal(Chunk a, char c) { return _mm256_cmpeq_epi8(a, Splat(c)); }
+    inline Chunk Or(Chunk a, Chunk b) { return _mm256_or_si256(a, b); }
+    inline Chunk InRange(Chunk a, char low, char high) { return _mm256_and_si256(_mm256_cmpgt_epi8(a, Splat(low - 1)), _mm256_cmpgt_epi8(Splat(high + 1), a)); }
+    inline uint32_t Mask(Chunk a) { return static_cast<uint32_t>(_mm256_movemask_epi8(a)); }
+#elif defined(__SSE2__)
+    using Chunk = __m128i;
+    constexpr uintptr_t ChunkSize = 16;
+    constexpr uint32_t FullMask = 0xFFFF;
+
+    inline Chunk Load(const char *p) { return _mm_load_si128(reinterpret_cast<const Chunk *>(p)); }
+    inline Chunk Splat(char c) { return _mm_set1_epi8(c); }
+    inline Chunk Equal(Chunk a, char c) { return _mm_cmpeq_epi8(a, Splat(c)); }
+    inline Chunk Or(Chunk a, Chunk b) { return _mm_or_si128(a, b); }
+    inline Chunk InRange(Chunk a, char low, char high) { return _mm_and_si128(_mm_cmpgt_epi8(a, Splat(low - 1)), _mm_cmpgt_epi8(Splat(high + 1), a)); }
+    inline uint32_t Mask(Chunk a) { return static_cast<uint32_t>(_mm_movemask_epi8(a)); }
+#endif
+
+#if defined(__SSE2__)
+    // First byte at or after p whose bit is set in the mask produced by match. Loads are
+    // aligned so they never touch a page that p's chunk doesn't already live in.
+    template <typename Match>
+    inline const char *FindFirst(const char *p, Match match)
+    {
+        auto offset = reinterpret_cast<uintptr_t>(p) & (ChunkSize - 1);
+        const char *chunk = p - offset;
+
+        uint32_t mask = (match(Load(chunk)) & FullMask) >> offset;
+        if (mask)
+            return p + __builtin_ctz(mask);
+
+        for (chunk += ChunkSize;; chunk += ChunkSize)
+        {
+            mask = match(Load(chunk)) & FullMask;
+            if (mask)
+                return chunk + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    inline bool IsIdentifier(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    // End of a run of identifier characters
+    inline const char *IdentifierEnd(const char *p)
+    {
+#if defined(__SSE2__)
+        return FindFirst(p, [](Chunk c) {
+            auto lower = Or(c, Splat(0x20));
+            auto ident = Or(Or(InRange(lower, 'a', 'z'), InRange(c, '0', '9')), Equal(c, '_'));
+            return ~Mask(ident);
+        });
+#else
+        while (IsIdentifier(*p))
+            p++;
+        return p;
+#endif
+    }
+
+    // End of a run of spaces
+    inline const char *SpacesEnd(const char *p)
+    {
+#if defined(__SSE2__)
+        return FindFirst(p, [](Chunk c) { return ~Mask(Equal(c, ' ')); });
+#else
+        while (*p == ' ')
+            p++;
+        return p;
+#endif
+    }
+
+    // Next '\r', '\n' or '\0'
+    inline const char *LineEnd(const char *p)
+    {
+#if defined(__SSE2__)
+        return FindFirst(p, [](Chunk c) { return Mask(Or(Or(Equal(c, '\r'), Equal(c, '\n')), Equal(c, '\0'))); });
+#else
+        while (*p != '\r' && *p != '\n' && *p != '\0')
+            p++;
+        return p;
+#endif
+    }
+
+    // Next quote of either kind or '\0'
+    inline const char *QuoteEnd(const char *p)
+    {
+#if defined(__SSE2__)
+        return FindFirst(p, [](Chunk c) { return Mask(Or(Or(Equal(c, '"'), Equal(c, '\'')), Equal(c, '\0'))); });
+#else
+        while (*p != '"' && *p != '\'' && *p != '\0')
+            p++;
+        return p;
+#endif
+    }
+
+    // Start of the next "*/" or the '\0' ending the buffer
+    inline const char *BlockCommentEnd(const char *p)
+    {
+        while (true)
+        {
+#if defined(__SSE2__)
+            p = FindFirst(p, [](Chunk c) { return Mask(Or(Equal(c, '*'), Equal(c, '\0'))); });
+#else
+            while (*p != '*' && *p != '\0')
+                p++;
+#endif
+            if (*p == '\0' || p[1] == '/')
+                return p;
+            p++;
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <CodeGen.hpp>
+
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/LTO/LTO.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Links the bitcode of several modules into an executable with LTO's in process ThinLTO backend. The summaries
+// decide what each module imports from the others, then every module is optimized and compiled on its own thread
+class ThinLink
+{
+private:
+    std::unique_ptr<llvm::lto::LTO> lto;
+    std::deque<llvm::SmallVector<char, 0>> bitcodes; // The inputs refer into these until the link is done, so they never move
+    llvm::StringSet<> defined;                        // The first definition of a symbol wins
+    llvm::StringMap<std::string> strongDefinitions;   // The input each strong symbol is defined in
+
+public:
+    ThinLink(OptimizationLevel level, unsigned jobs);
+
+    bool Add(const std::string &name, llvm::SmallVector<char, 0> bitcode);
+    bool Link(const std::string &executable);
+};
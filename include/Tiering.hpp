@@ -0,0 +1,48 @@
+#pragma once
+#include <CodeGen.hpp>
+
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs a module in two tiers on an LLJIT. Every function starts out as it was generated, with a call counter at its
+// entry. The first time a counter reaches the threshold the function is optimized on a background thread, and from
+// then on its entry forwards to the optimized version
+class TieredModule
+{
+private:
+    llvm::orc::LLJIT &jit;
+    OptimizationLevel level; // Of the optimized tier
+    uint32_t threshold;
+    std::unique_ptr<llvm::TargetMachine> target; // Host target the optimized tier is tuned for
+
+    llvm::SmallVector<char, 0> bitcode; // The module before it was instrumented, optimized tiers are cut from it
+    std::vector<std::string> functions; // Instrumented functions by the index passed to RequestTierUp
+    std::vector<void **> targets;       // Where each function's entry looks for its optimized version
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<uint32_t> hot; // Functions waiting to be optimized
+    bool stopping = false;
+    std::thread worker;
+
+public:
+    TieredModule(llvm::orc::LLJIT &jit, OptimizationLevel level, uint32_t threshold);
+    ~TieredModule();
+
+    llvm::Error Add(llvm::orc::ThreadSafeModule module);
+
+private:
+    void Instrument(llvm::Module &module);
+    void Work();
+    void TierUp(uint32_t index);
+
+    static void RequestTierUp(TieredModule *tiers, uint32_t index);
+};
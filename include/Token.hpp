@@ -1,12 +1,19 @@
 #pragma once
 #include <stdint.h>
 #include <string>
+#include <string_view>
+#include <charconv>
 #include <ostream>
 #include <fstream>
 #include <iostream>
 #include <cassert>
 #include <vector>
 #include <memory>
+#include <cstring>
+#include <algorithm>
+#include <Interner.hpp>
+#include <Casting.hpp>
+#include <Ref.hpp>
 
 struct Position;
 class CodeGeneration;
@@ -45,6 +52,8 @@ namespace Parsing
         TemplateStatement,
         SpecStatement,
         BlockStatement,
+        EnumBlockStatement,
+        MatchBlockStatement,
         ExpressionStatement,
         VariableDeclerationStatement,
         FunctionDeclerationStatement,
@@ -81,24 +90,24 @@ namespace Parsing
 
         const virtual SyntaxType GetType() const = 0;
 
-        const virtual uint8_t NumChildren() const = 0;
+        const virtual uint32_t NumChildren() const = 0;
         const virtual SyntaxNode &operator[](int index) const = 0;
 
-        virtual std::shared_ptr<CodeValue> CodeGen(CodeGeneration &gen) const { return nullptr; }
+        virtual Ref<CodeValue> CodeGen(CodeGeneration &gen) const;
         virtual void PreCodeGen(CodeGeneration &gen) const {}
 
         virtual const Position &GetStart() const = 0;
         virtual const Position &GetEnd() const = 0;
 
         template <typename T>
-        const T &As() const { return *dynamic_cast<const T *>(this); }
+        const T &As() const { return *cast<T>(this); }
 
         template <typename T>
-        T &As() { return *dynamic_cast<T *>(this); }
+        T &As() { return *cast<T>(this); }
     };
 } // namespace Parsing
 
-enum class TokenType
+enum class TokenType : uint8_t
 {
     Eof,
     Newline,
@@ -251,59 +260,61 @@ struct Range
     }
 };
 
-struct Token : public Parsing::SyntaxNode
+// Plain token record. raw views the token's text in the source buffer so tokens are cheap to copy
+struct Token
 {
     TokenType type;
     Range position;
-    std::string raw;
+    std::string_view raw;
     union
     {
         uint64_t ivalue;
         double fvalue;
+        InternId id; // Identifiers
     };
 
-    Token() : type{TokenType::Eof}, position{}, raw{""}, ivalue{0}
+    Token() : type{TokenType::Eof}, position{}, raw{}, ivalue{0}
     {
     }
 
-    Token(TokenType type) : type{type}, position{}, raw{""}, ivalue{0}
+    Token(TokenType type) : type{type}, position{}, raw{}, ivalue{0}
     {
     }
 
-    Token(TokenType type, Range position) : type{type}, position{position}, raw{""}, ivalue{0}
+    Token(TokenType type, Range position) : type{type}, position{position}, raw{}, ivalue{0}
     {
     }
 
-    Token(TokenType type, Range position, std::string raw) : type{type}, position{position}, raw{raw}, ivalue{0}
+    Token(TokenType type, Range position, std::string_view raw) : type{type}, position{position}, raw{raw}, ivalue{0}
     {
         switch (type)
         {
         case TokenType::Integer:
         {
-            ivalue = std::stoi(raw);
+            std::from_chars(raw.data(), raw.data() + raw.size(), ivalue, 10);
             break;
         }
         case TokenType::HexInt:
         {
-            ivalue = std::stoi(raw, nullptr, 16);
+            std::from_chars(raw.data() + 2, raw.data() + raw.size(), ivalue, 16);
             this->type = TokenType::Integer;
             break;
         }
         case TokenType::OctInt:
         {
-            ivalue = std::stoi(raw, nullptr, 8);
+            std::from_chars(raw.data() + 2, raw.data() + raw.size(), ivalue, 8);
             this->type = TokenType::Integer;
             break;
         }
         case TokenType::BinInt:
         {
-            ivalue = std::stoi(raw, nullptr, 2);
+            std::from_chars(raw.data() + 2, raw.data() + raw.size(), ivalue, 2);
             this->type = TokenType::Integer;
             break;
         }
         case TokenType::Floating:
         {
-            fvalue = std::stod(raw);
+            fvalue = std::stod(std::string(raw));
             break;
         }
         default:
@@ -320,27 +331,12 @@ struct Token : public Parsing::SyntaxNode
         return !operator==(other);
     }
 
-    const virtual Parsing::SyntaxType GetType() const override
-    {
-        return Parsing::SyntaxType::None;
-    }
-
-    const virtual uint8_t NumChildren() const override
-    {
-        return 0;
-    }
-
-    const virtual SyntaxNode &operator[](int index) const override
-    {
-        return *this;
-    }
-
-    virtual const Position &GetStart() const override
+    const Position &GetStart() const
     {
         return position.start;
     }
 
-    virtual const Position &GetEnd() const override
+    const Position &GetEnd() const
     {
         return position.end;
     }
@@ -487,6 +483,34 @@ struct Token : public Parsing::SyntaxNode
 //     PointerType token;
 // };
 
+// Source file mapped into memory followed by a zero filled tail so the tokenizer can read ahead of the end
+class SourceBuffer
+{
+public:
+    static constexpr size_t SentinelSize = 32;
+
+    SourceBuffer(const std::string &filename);
+    ~SourceBuffer();
+
+    SourceBuffer(const SourceBuffer &) = delete;
+    SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+    char *Data() const { return data; }
+    size_t Size() const { return size; }
+
+    // Offset of the first character of each line
+    const std::vector<uint64_t> &GetLineStarts() const { return lineStarts; }
+
+private:
+    void BuildLineTable();
+
+private:
+    char *data;
+    size_t size;
+    size_t mappedSize;
+    std::vector<uint64_t> lineStarts;
+};
+
 class FileIterator
 {
 public:
@@ -495,22 +519,14 @@ public:
     using ReferenceType = ValueType &;
 
 public:
-    FileIterator(PointerType token) : ptr{token}, fileName{""}
+    FileIterator(PointerType token) : ptr{token}, beg{token}, fileName{""}
     {
     }
 
-    FileIterator(std::string filename) : ptr{nullptr}, fileName{filename}
+    FileIterator(std::string filename) : ptr{nullptr}, fileName{filename}, source{std::make_shared<SourceBuffer>(filename)}
     {
-        std::ifstream file(fileName, std::ios::binary | std::ios::ate);
-        size = file.tellg();
-        file.seekg(0, std::ios::beg);
-
-        ptr = beg = new char[size + 32];
-        memset(ptr + size, 0, 32);
-        if (!file.read(ptr, size))
-        {
-            std::cerr << "Unable to read file: " << fileName << std::endl;
-        }
+        ptr = beg = source->Data();
+        size = source->Size();
     }
 
     FileIterator &operator++()
@@ -649,6 +665,17 @@ public:
         return *ptr;
     }
 
+    const ValueType *GetPointer() const
+    {
+        return ptr;
+    }
+
+    // Jump to a position found by scanning the buffer directly
+    void Seek(const ValueType *position)
+    {
+        ptr = beg + (position - beg);
+    }
+
     uint64_t Offset() const
     {
         return (uint64_t)ptr - (uint64_t)beg;
@@ -659,65 +686,39 @@ public:
         Position position;
         position.line = 0;
         position.character = 0;
-        for (size_t i = 0; i < Offset(); i++)
-        {
-            if (beg[i] == '\r' && beg[i + 1] == '\n')
-            {
-                position.line++;
-                position.character = 0;
-                i++;
-            }
-            else if (beg[i] == '\r' || beg[i] == '\n')
-            {
-                position.line++;
-                position.character = 0;
-                i++;
-            }
-            else
-            {
-                position.character++;
-            }
-        }
+        if (!source)
+            return position;
+
+        // Last line starting at or before the current offset
+        auto &lineStarts = source->GetLineStarts();
+        auto offset = Offset();
+        auto line = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset) - 1;
+        position.line = static_cast<uint32_t>(line - lineStarts.begin());
+        position.character = static_cast<uint32_t>(offset - *line);
         return position;
     }
 
     char *FindLine(uint32_t line, uint32_t &len) const
     {
-        uint32_t current = 0;
-        size_t i;
-        for (i = 0; i < size; i++)
-        {
-            if (beg[i] == '\r' && beg[i + 1] == '\n')
-            {
-                current++;
-                i++;
-            }
-            else if (beg[i] == '\r' || beg[i] == '\n')
-            {
-                current++;
-                i++;
-            }
-            else if (current == line)
-            {
-                uint32_t j;
-                for (j = 0; *(beg + i + j) != '\r' && *(beg + i + j) != '\n' && *(beg + i + j) != '\0'; j++)
-                    ;
-                len = j;
-                return beg + i;
-            }
-        }
-        return nullptr;
+        if (!source || line >= source->GetLineStarts().size())
+            return nullptr;
+
+        auto start = beg + source->GetLineStarts()[line];
+        uint32_t j;
+        for (j = 0; start[j] != '\r' && start[j] != '\n' && start[j] != '\0'; j++)
+            ;
+        len = j;
+        return start;
     }
 
     std::string StringFromRange(Range range)
     {
-        uint32_t firstLen = 0;
-        auto first = FindLine(range.start.line, firstLen);
-        first += range.start.character;
+        if (!source)
+            return "";
 
-        uint32_t secondLen = 0;
-        auto second = FindLine(range.end.line, firstLen);
-        second += range.end.character;
+        auto &lineStarts = source->GetLineStarts();
+        auto first = beg + lineStarts[range.start.line] + range.start.character;
+        auto second = beg + lineStarts[range.end.line] + range.end.character;
 
         return std::string(first, (size_t)second - (size_t)first);
     }
@@ -737,6 +738,7 @@ private:
     PointerType beg;
     std::streamsize size;
     std::string fileName;
+    std::shared_ptr<SourceBuffer> source;
 };
 
 using TokenList = std::vector<Token>;
@@ -31,7 +31,10 @@ public:
     IterateType String();
     bool Comment();
     IterateType IterateTrie();
-    IterateType IterateTrieRec(const TrieNode &node, bool use, Position startPosition);
     const bool IsDirty() const { return dirty; }
     const auto &GetFileIterator() const { return fptr; }
+
+private:
+    // Source text from start up to the current position
+    std::string_view Slice(const char *start) const { return std::string_view(start, fptr.GetPointer() - start); }
 };
\ No newline at end of file
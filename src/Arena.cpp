@@ -0,0 +1,17 @@
+#include <Arena.hpp>
+
+void *Arena::AllocateSlow(size_t size, size_t align)
+{
+    // Oversized requests get a block of their own so the current block keeps its free space
+    size_t blockSize = size + align > BlockSize ? size + align : BlockSize;
+    blocks.emplace_back(new char[blockSize]);
+    char *block = blocks.back().get();
+    auto aligned = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(block) + align - 1) & ~(uintptr_t)(align - 1));
+
+    if (blockSize == BlockSize || ptr == nullptr)
+    {
+        ptr = aligned + size;
+        end = block + blockSize;
+    }
+    return aligned;
+}
@@ -4,6 +4,19 @@
 
 #include <llvm/IR/Value.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Analysis/ModuleSummaryAnalysis.h>
+#include <llvm/Analysis/ProfileSummaryInfo.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/MC/SubtargetFeature.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/TargetRegistry.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetMachine.h>
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/Type.h>
 #include <llvm/Transforms/Utils/BasicBlockUtils.h>
@@ -34,7 +47,7 @@ std::string gen_random(const int len)
 
 using namespace Parsing;
 
-std::string LLVMTypeToString(std::shared_ptr<CodeType> base, llvm::Type *type)
+std::string LLVMTypeToString(Ref<CodeType> base, llvm::Type *type)
 {
     switch (type->getTypeID())
     {
@@ -81,9 +94,9 @@ std::string LLVMTypeToString(std::shared_ptr<CodeType> base, llvm::Type *type)
     return "";
 }
 
-std::string TypeToString(std::shared_ptr<CodeType> type)
+std::string TypeToString(Ref<CodeType> type)
 {
-    if (auto templ = std::dynamic_pointer_cast<TemplateCodeType>(type))
+    if (auto templ = DynamicRefCast<TemplateCodeType>(type))
     {
         std::string s = "";
         if (templ->type->isPointerTy())
@@ -91,7 +104,7 @@ std::string TypeToString(std::shared_ptr<CodeType> type)
         s += templ->node.GetParent()->findSymbol(&templ->node);
         return s;
     }
-    else if (auto func = std::dynamic_pointer_cast<FunctionCodeType>(type))
+    else if (auto func = DynamicRefCast<FunctionCodeType>(type))
     {
         std::string s = "(";
         // auto func = static_cast<llvm::FunctionType *>(base->type);
@@ -115,23 +128,58 @@ std::string TypeToString(std::shared_ptr<CodeType> type)
 
 // SymbolNode CodeGeneration::rootSymbols(nullptr);
 
-std::shared_ptr<CodeType> CodeGeneration::LiteralType(const SyntaxNode &node)
+Ref<CodeType> CodeGeneration::GetCodeType(llvm::Type *type, bool isSigned, bool isChar, bool isBool)
+{
+    auto &canonical = plainTypes[PlainTypeKey(type, isSigned, isChar, isBool)];
+    if (!canonical)
+        canonical = MakeRef<CodeType>(type, isSigned, isChar, isBool);
+    return canonical;
+}
+
+Ref<CodeType> CodeGeneration::GetCodeType(const CodeType &type)
+{
+    return GetCodeType(type.type, type.isSigned, type.isChar, type.isBool);
+}
+
+Ref<ArrayCodeType> CodeGeneration::GetArrayCodeType(llvm::Type *type, Ref<CodeType> baseType)
+{
+    auto &canonical = arrayTypes[std::make_pair(type, baseType.get())];
+    if (!canonical)
+        canonical = MakeRef<ArrayCodeType>(type, baseType);
+    return canonical;
+}
+
+// Same kind of type as the given one but with a different llvm type. Types are shared so this never modifies type
+Ref<CodeType> CodeGeneration::Retype(const Ref<CodeType> &type, llvm::Type *to)
+{
+    if (type->type == to)
+        return type;
+    if (auto templ = DynamicRefCast<TemplateCodeType>(type))
+        return MakeRef<TemplateCodeType>(to, templ->GetNode());
+    if (auto spec = DynamicRefCast<SpecCodeType>(type))
+        return MakeRef<SpecCodeType>(to, spec->GetNode());
+    if (auto array = DynamicRefCast<ArrayCodeType>(type))
+        return GetArrayCodeType(to, array->GetBaseType());
+    return GetCodeType(to, type->isSigned, type->isChar, type->isBool);
+}
+
+Ref<CodeType> CodeGeneration::LiteralType(const SyntaxNode &node)
 {
     switch (node.GetType())
     {
     case SyntaxType::Integer:
     {
         auto value = node.As<IntegerSyntax>().GetValue();
-        return std::make_shared<CodeType>(llvm::IntegerType::get(context, GetNumBits(value)));
+        return GetCodeType(llvm::IntegerType::get(context, GetNumBits(value)));
     }
     case SyntaxType::Floating:
-        return std::make_shared<CodeType>(llvm::Type::getDoubleTy(context));
+        return GetCodeType(llvm::Type::getDoubleTy(context));
     // case SyntaxType::Char:
     //     return std::make_shared<CodeType>(llvm::Type::getDoubleTy(context));
     case SyntaxType::Boolean:
-        return std::make_shared<CodeType>(llvm::Type::getInt1Ty(context), false, false, true);
+        return GetCodeType(llvm::Type::getInt1Ty(context), false, false, true);
     case SyntaxType::String:
-        return std::make_shared<CodeType>(llvm::ArrayType::get(llvm::Type::getInt8Ty(context), node.As<StringSyntax>().GetValue().size() + 1));
+        return GetCodeType(llvm::ArrayType::get(llvm::Type::getInt8Ty(context), node.As<StringSyntax>().GetValue().size() + 1));
     case SyntaxType::ArrayLiteral:
     {
         auto arr = node.As<ArrayLiteral>();
@@ -144,7 +192,7 @@ std::shared_ptr<CodeType> CodeGeneration::LiteralType(const SyntaxNode &node)
         }
         else
         {
-            return std::make_shared<CodeType>(llvm::ArrayType::get(llvm::Type::getInt8Ty(context), node.As<ArrayLiteral>().GetValues().size() + 1));
+            return GetCodeType(llvm::ArrayType::get(llvm::Type::getInt8Ty(context), node.As<ArrayLiteral>().GetValues().size() + 1));
         }
     }
     default:
@@ -152,7 +200,42 @@ std::shared_ptr<CodeType> CodeGeneration::LiteralType(const SyntaxNode &node)
     }
 }
 
-std::shared_ptr<CodeType> CodeGeneration::TypeType(const SyntaxNode &node)
+// Resolve each argument of a generic type in the current scope. Arguments that fail are left null.
+std::vector<Ref<CodeType>> CodeGeneration::ResolveGenericArguments(const GenericType &generic)
+{
+    std::vector<Ref<CodeType>> arguments;
+    for (auto p : generic.GetArguments())
+    {
+        try
+        {
+            arguments.push_back(TypeType(*p));
+        }
+        catch (const BaseException &ex)
+        {
+            arguments.push_back(nullptr);
+        }
+    }
+    return arguments;
+}
+
+CodeGeneration::GenericInstance CodeGeneration::GenericInstanceKey(SymbolNode *symbol, const std::vector<Ref<CodeType>> &arguments)
+{
+    // Plain, array and instantiated types are canonical so their address identifies them. Template and spec types
+    // are made per lookup, so they go by their symbol and llvm type instead
+    GenericInstance instance{symbol, {}};
+    for (const auto &a : arguments)
+    {
+        if (auto templ = DynamicRefCast<TemplateCodeType>(a))
+            instance.second.emplace_back(&templ->GetNode(), a->type);
+        else if (auto spec = DynamicRefCast<SpecCodeType>(a))
+            instance.second.emplace_back(&spec->GetNode(), a->type);
+        else
+            instance.second.emplace_back(a.get(), a ? a->type : nullptr);
+    }
+    return instance;
+}
+
+Ref<CodeType> CodeGeneration::TypeType(const SyntaxNode &node)
 {
     switch (node.GetType())
     {
@@ -162,15 +245,15 @@ std::shared_ptr<CodeType> CodeGeneration::TypeType(const SyntaxNode &node)
         switch (type.type)
         {
         case TokenType::Int:
-            return std::make_shared<CodeType>(llvm::IntegerType::get(context, type.ivalue == 0 ? 32 : type.ivalue), true);
+            return GetCodeType(llvm::IntegerType::get(context, type.ivalue == 0 ? 32 : type.ivalue), true);
         case TokenType::Uint:
-            return std::make_shared<CodeType>(llvm::IntegerType::get(context, type.ivalue == 0 ? 32 : type.ivalue), false);
+            return GetCodeType(llvm::IntegerType::get(context, type.ivalue == 0 ? 32 : type.ivalue), false);
         case TokenType::Float:
-            return std::make_shared<CodeType>(llvm::Type::getDoubleTy(context), false);
+            return GetCodeType(llvm::Type::getDoubleTy(context), false);
         case TokenType::Char:
-            return std::make_shared<CodeType>(llvm::IntegerType::get(context, 8), false, true);
+            return GetCodeType(llvm::IntegerType::get(context, 8), false, true);
         case TokenType::Bool:
-            return std::make_shared<CodeType>(llvm::Type::getInt1Ty(context), false, false, true);
+            return GetCodeType(llvm::Type::getInt1Ty(context), false, false, true);
 
         default:
             break;
@@ -178,26 +261,26 @@ std::shared_ptr<CodeType> CodeGeneration::TypeType(const SyntaxNode &node)
     }
     case SyntaxType::IdentifierType:
     {
-        if (auto sym = FindSymbolInScope(node.As<IdentifierType>().GetToken().raw))
+        if (auto sym = FindSymbolInScope(node.As<IdentifierType>().GetToken().id))
         {
             switch (sym->GetType())
             {
             case SymbolNodeType::TemplateNode:
-                return dynamic_cast<TemplateNode *>(sym)->GetTemplate();
+                return cast<TemplateNode>(sym)->GetTemplate();
                 // return std::make_shared<TemplateCodeValue>(static_cast<llvm::StructType *>(dynamic_cast<TemplateNode *>(sym)->GetTemplate()->type), *dynamic_cast<TemplateNode *>(sym));
             case SymbolNodeType::TypeAliasNode:
-                return dynamic_cast<TypeAliasNode *>(sym)->GetReferencedType();
+                return cast<TypeAliasNode>(sym)->GetReferencedType();
                 // return std::make_shared<TemplateCodeValue>(static_cast<llvm::StructType *>(dynamic_cast<TemplateNode *>(sym)->GetTemplate()->type), *dynamic_cast<TemplateNode *>(sym));
             case SymbolNodeType::SpecNode:
                 // return dynamic_cast<SpecNode *>(sym).
-                return std::make_shared<SpecCodeType>(nullptr, *dynamic_cast<SpecNode *>(sym));
+                return MakeRef<SpecCodeType>(nullptr, *cast<SpecNode>(sym));
             default:
                 return nullptr;
             }
         }
         ThrowCompilerError(
             ErrorType::Type, ErrorCode::UnkownType,
-            "Unkown type `" + node.As<IdentifierType>().GetToken().raw + "`",
+            "Unkown type `" + std::string(node.As<IdentifierType>().GetToken().raw) + "`",
             Range(node.GetStart(), node.GetEnd()));
         return nullptr;
     }
@@ -207,7 +290,7 @@ std::shared_ptr<CodeType> CodeGeneration::TypeType(const SyntaxNode &node)
         auto type = TypeType(arr.GetArrayType());
         auto &size = arr.GetArraySize();
         if (size.GetType() == SyntaxType::Integer)
-            return std::make_shared<CodeType>(llvm::ArrayType::get(type->type, size.As<IntegerSyntax>().GetValue()));
+            return GetCodeType(llvm::ArrayType::get(type->type, size.As<IntegerSyntax>().GetValue()));
         else
             return nullptr;
     }
@@ -215,7 +298,7 @@ std::shared_ptr<CodeType> CodeGeneration::TypeType(const SyntaxNode &node)
     {
         auto arr = node.As<ReferenceType>();
         auto type = TypeType(arr.GetReferenceType());
-        return std::make_shared<CodeType>(llvm::PointerType::get(type->type, 0));
+        return GetCodeType(llvm::PointerType::get(type->type, 0));
     }
     case SyntaxType::FunctionType:
     {
@@ -225,15 +308,15 @@ std::shared_ptr<CodeType> CodeGeneration::TypeType(const SyntaxNode &node)
         for (auto a : arr.GetParameters())
             parameters.push_back(TypeType(*a)->type);
         if (type)
-            return std::make_shared<CodeType>(llvm::FunctionType::get(type->type, parameters, false)->getPointerTo());
+            return GetCodeType(llvm::FunctionType::get(type->type, parameters, false)->getPointerTo());
         else
-            return std::make_shared<CodeType>(llvm::FunctionType::get(llvm::Type::getVoidTy(context), parameters, false)->getPointerTo());
+            return GetCodeType(llvm::FunctionType::get(llvm::Type::getVoidTy(context), parameters, false)->getPointerTo());
     }
     case SyntaxType::GenericType:
     {
         auto &generic = node.As<GenericType>();
         auto &identifier = generic.GetBaseType()->As<IdentifierType>();
-        auto symbol = FindSymbolInScope(identifier.GetToken().raw);
+        auto symbol = FindSymbolInScope(identifier.GetToken().id);
         if (symbol)
         {
             if (const auto templ = symbol->Cast<TemplateNode>())
@@ -246,23 +329,38 @@ std::shared_ptr<CodeType> CodeGeneration::TypeType(const SyntaxNode &node)
                         Range(generic.GetLeft().position.start, generic.GetRight().position.end));
                 }
 
+                auto arguments = ResolveGenericArguments(generic);
+                bool bad = std::find(arguments.begin(), arguments.end(), nullptr) != arguments.end();
+                auto instance = GenericInstanceKey(templ, arguments);
+                if (!bad)
+                {
+                    auto cached = genericInstances.find(instance);
+                    if (cached != genericInstances.end())
+                        return cached->second;
+                }
+
                 auto lastPoint = insertPoint;
                 insertPoint = templ->GetParent();
 
                 auto structType = llvm::StructType::create(context, GenerateMangledTypeName(identifier.GetToken().raw));
-                const auto newTempl = symbol->GetParent()->AddChild<TemplateNode>(identifier.GetToken().raw + symbol->GetParent()->GenerateName(), structType);
+                const auto newTempl = symbol->GetParent()->AddChild<TemplateNode>(Interner::Intern(std::string(identifier.GetToken().raw) + symbol->GetParent()->GenerateName()), structType);
                 insertPoint = lastPoint;
 
                 auto it = templ->GetGeneric()->GetParameters().begin();
-                bool bad = false;
+                auto arg = arguments.begin();
                 for (auto p : generic.GetArguments())
                 {
                     try
                     {
-                        auto rType = TypeType(*p);
+                        auto rType = *arg++;
+                        if (!rType)
+                        {
+                            it++;
+                            continue;
+                        }
                         for (auto constrait : (*it)->GetConstraints())
                         {
-                            if (!TypeImplements(rType, &(std::dynamic_pointer_cast<SpecCodeType>(TypeType(*constrait))->GetNode())))
+                            if (!TypeImplements(rType, &(DynamicRefCast<SpecCodeType>(TypeType(*constrait))->GetNode())))
                             {
                                 ThrowCompilerError(
                                     ErrorType::Generic, ErrorCode::ArgMisMatch,
@@ -270,7 +368,7 @@ std::shared_ptr<CodeType> CodeGeneration::TypeType(const SyntaxNode &node)
                                     Range(p->GetStart(), p->GetEnd()));
                             }
                         }
-                        auto found = templ->findSymbol((*it)->GetIdentifier().raw);
+                        auto found = templ->findSymbol((*it)->GetIdentifier().id);
                         if (found != templ->children.end())
                         {
                             if (found->second->GetType() == SymbolNodeType::TypeAliasNode)
@@ -294,6 +392,9 @@ std::shared_ptr<CodeType> CodeGeneration::TypeType(const SyntaxNode &node)
                         "Aborting due to generic type error",
                         Range(),
                         CreateSnippet(Range(templ->GetGeneric()->GetLeft().position.start, templ->GetGeneric()->GetRight().position.end), "Generic parameters have constraints:"));
+
+                // Cached before the body is generated so members referring back to this instance see the same type
+                genericInstances[instance] = newTempl->GetTemplate();
                 insertPoint = newTempl;
 
                 Use(CodeGeneration::Using::NoBlock);
@@ -316,22 +417,37 @@ std::shared_ptr<CodeType> CodeGeneration::TypeType(const SyntaxNode &node)
                         Range(generic.GetLeft().position.start, generic.GetRight().position.end));
                 }
 
+                auto arguments = ResolveGenericArguments(generic);
+                bool bad = std::find(arguments.begin(), arguments.end(), nullptr) != arguments.end();
+                auto instance = GenericInstanceKey(typeAlias, arguments);
+                if (!bad)
+                {
+                    auto cached = genericInstances.find(instance);
+                    if (cached != genericInstances.end())
+                        return cached->second;
+                }
+
                 auto lastPoint = insertPoint;
                 insertPoint = typeAlias->GetParent();
 
-                const auto newTempl = symbol->GetParent()->AddChild<TypeAliasNode>(identifier.GetToken().raw + symbol->GetParent()->GenerateName());
+                const auto newTempl = symbol->GetParent()->AddChild<TypeAliasNode>(Interner::Intern(std::string(identifier.GetToken().raw) + symbol->GetParent()->GenerateName()));
                 insertPoint = newTempl;
 
                 auto it = typeAlias->GetGeneric()->GetParameters().begin();
-                bool bad = false;
+                auto arg = arguments.begin();
                 for (auto p : generic.GetArguments())
                 {
                     try
                     {
-                        auto rType = TypeType(*p);
+                        auto rType = *arg++;
+                        if (!rType)
+                        {
+                            it++;
+                            continue;
+                        }
                         for (auto constrait : (*it)->GetConstraints())
                         {
-                            if (!TypeImplements(rType, &(std::dynamic_pointer_cast<SpecCodeType>(TypeType(*constrait))->GetNode())))
+                            if (!TypeImplements(rType, &(DynamicRefCast<SpecCodeType>(TypeType(*constrait))->GetNode())))
                             {
                                 ThrowCompilerError(
                                     ErrorType::Generic, ErrorCode::ArgMisMatch,
@@ -339,14 +455,14 @@ std::shared_ptr<CodeType> CodeGeneration::TypeType(const SyntaxNode &node)
                                     Range(p->GetStart(), p->GetEnd()));
                             }
                         }
-                        auto found = typeAlias->findSymbol((*it)->GetIdentifier().raw);
+                        auto found = typeAlias->findSymbol((*it)->GetIdentifier().id);
                         if (found != typeAlias->children.end())
                         {
                             if (found->second->GetType() == SymbolNodeType::TypeAliasNode)
                             {
                                 auto &node = found->second->As<TypeAliasNode>();
 
-                                node.SetReferencedType(TypeType(*p));
+                                node.SetReferencedType(rType);
                                 insertPoint->AddChild<TypeAliasNode>(found->first, node);
                             }
                         }
@@ -368,6 +484,7 @@ std::shared_ptr<CodeType> CodeGeneration::TypeType(const SyntaxNode &node)
 
                 // typeAlias->GetBody()->CodeGen(*this);
                 newTempl->SetReferencedType(TypeType(*typeAlias->GetBody()));
+                genericInstances[instance] = newTempl->GetReferencedType();
 
                 insertPoint = lastPoint;
 
@@ -378,7 +495,7 @@ std::shared_ptr<CodeType> CodeGeneration::TypeType(const SyntaxNode &node)
         {
             ThrowCompilerError(
                 ErrorType::TemplateInitializer, ErrorCode::CannotFind,
-                std::string("Cannot find type ") + identifier.GetToken().raw + " in scope!",
+                std::string("Cannot find type ") + std::string(identifier.GetToken().raw) + " in scope!",
                 Range(identifier.GetStart(), identifier.GetEnd()));
         }
     }
@@ -414,16 +531,16 @@ bool CodeGeneration::TypeImplements(const SyntaxNode &node, SpecNode *spec)
     }
     case SyntaxType::IdentifierType:
     {
-        if (auto sym = FindSymbolInScope(node.As<IdentifierType>().GetToken().raw))
+        if (auto sym = FindSymbolInScope(node.As<IdentifierType>().GetToken().id))
         {
             switch (sym->GetType())
             {
             case SymbolNodeType::TemplateNode:
 
-                return TypeImplements(dynamic_cast<TemplateNode *>(sym)->GetTemplate(), spec);
+                return TypeImplements(cast<TemplateNode>(sym)->GetTemplate(), spec);
                 // return std::make_shared<TemplateCodeValue>(static_cast<llvm::StructType *>(dynamic_cast<TemplateNode *>(sym)->GetTemplate()->type), *dynamic_cast<TemplateNode *>(sym));
             case SymbolNodeType::TypeAliasNode:
-                return TypeImplements(dynamic_cast<TypeAliasNode *>(sym)->GetReferencedType(), spec);
+                return TypeImplements(cast<TypeAliasNode>(sym)->GetReferencedType(), spec);
                 // return dynamic_cast<TypeAliasNode *>(sym)->GetReferencedType();
                 // return std::make_shared<TemplateCodeValue>(static_cast<llvm::StructType *>(dynamic_cast<TemplateNode *>(sym)->GetTemplate()->type), *dynamic_cast<TemplateNode *>(sym));
             // case SymbolNodeType::SpecNode:
@@ -435,7 +552,7 @@ bool CodeGeneration::TypeImplements(const SyntaxNode &node, SpecNode *spec)
         }
         ThrowCompilerError(
             ErrorType::Type, ErrorCode::UnkownType,
-            "Unkown type `" + node.As<IdentifierType>().GetToken().raw + "`",
+            "Unkown type `" + std::string(node.As<IdentifierType>().GetToken().raw) + "`",
             Range(node.GetStart(), node.GetEnd()));
         return false;
     }
@@ -554,22 +671,22 @@ bool CodeGeneration::TypeImplements(const SyntaxNode &node, SpecNode *spec)
     }
 }
 
-bool CodeGeneration::TypeImplements(std::shared_ptr<CodeType> type, SpecNode *spec)
+bool CodeGeneration::TypeImplements(Ref<CodeType> type, SpecNode *spec)
 {
-    if (auto templ = std::dynamic_pointer_cast<TemplateCodeType>(type))
+    if (auto templ = DynamicRefCast<TemplateCodeType>(type))
     {
         const auto &specs = templ->GetNode().GetImplementedSpecs();
         auto found = std::find(specs.begin(), specs.end(), spec);
         if (found != specs.end())
             return true;
     }
-    else if (auto templ = std::dynamic_pointer_cast<ArrayCodeType>(type))
+    else if (auto templ = DynamicRefCast<ArrayCodeType>(type))
     {
     }
-    else if (auto templ = std::dynamic_pointer_cast<FunctionCodeType>(type))
+    else if (auto templ = DynamicRefCast<FunctionCodeType>(type))
     {
     }
-    else if (auto templ = std::dynamic_pointer_cast<SpecCodeType>(type))
+    else if (auto templ = DynamicRefCast<SpecCodeType>(type))
     {
     }
     else
@@ -591,7 +708,7 @@ bool CodeGeneration::TypeImplements(std::shared_ptr<CodeType> type, SpecNode *sp
     return false;
 }
 
-std::shared_ptr<CodeValue> CodeGeneration::Cast(std::shared_ptr<CodeValue> value, std::shared_ptr<CodeType> toType, bool implicit)
+Ref<CodeValue> CodeGeneration::Cast(Ref<CodeValue> value, Ref<CodeType> toType, bool implicit)
 {
     auto vt = value->type->type->getTypeID();
     auto tt = toType->type->getTypeID();
@@ -603,16 +720,16 @@ std::shared_ptr<CodeValue> CodeGeneration::Cast(std::shared_ptr<CodeValue> value
         return std::move(value);
     else if ((vt == llvm::Type::FloatTyID || vt == llvm::Type::DoubleTyID) && (tt == llvm::Type::FloatTyID || tt == llvm::Type::DoubleTyID))
     {
-        return std::make_shared<CodeValue>(builder.CreateFPCast(value->value, toType->type), toType);
+        return MakeRef<CodeValue>(builder.CreateFPCast(value->value, toType->type), toType);
     }
     else if ((vt == llvm::Type::FloatTyID || vt == llvm::Type::DoubleTyID) && (tt == llvm::Type::IntegerTyID))
     {
         if (!implicit)
         {
             if (toType->isSigned)
-                return std::make_shared<CodeValue>(builder.CreateFPToSI(value->value, toType->type), toType);
+                return MakeRef<CodeValue>(builder.CreateFPToSI(value->value, toType->type), toType);
             else
-                return std::make_shared<CodeValue>(builder.CreateFPToUI(value->value, toType->type), toType);
+                return MakeRef<CodeValue>(builder.CreateFPToUI(value->value, toType->type), toType);
         }
         else
         {
@@ -627,14 +744,14 @@ std::shared_ptr<CodeValue> CodeGeneration::Cast(std::shared_ptr<CodeValue> value
     else if ((tt == llvm::Type::FloatTyID || tt == llvm::Type::DoubleTyID) && (vt == llvm::Type::IntegerTyID))
     {
         if (toType->isSigned)
-            return std::make_shared<CodeValue>(builder.CreateSIToFP(value->value, toType->type), toType);
+            return MakeRef<CodeValue>(builder.CreateSIToFP(value->value, toType->type), toType);
         else
-            return std::make_shared<CodeValue>(builder.CreateUIToFP(value->value, toType->type), toType);
+            return MakeRef<CodeValue>(builder.CreateUIToFP(value->value, toType->type), toType);
     }
     else if (value->type->type != toType->type || value->type->isSigned != toType->isSigned)
     {
         auto val = builder.CreateIntCast(value->value, toType->type, toType->isSigned);
-        return std::make_shared<CodeValue>(val, toType);
+        return MakeRef<CodeValue>(val, toType);
     }
     return nullptr;
 }
@@ -659,14 +776,14 @@ uint8_t CodeGeneration::GetNumBits(uint64_t val)
         return 64;
 }
 
-std::shared_ptr<TemplateCodeType> CodeGeneration::TypeFromObjectInitializer(const SyntaxNode &object)
+Ref<TemplateCodeType> CodeGeneration::TypeFromObjectInitializer(const SyntaxNode &object)
 {
     if (object.GetType() == SyntaxType::ObjectInitializer)
     {
         const auto &init = object.As<ObjectInitializer>();
 
         auto structType = llvm::StructType::create(context, GenerateMangledTypeName("anon"));
-        auto node = insertPoint->AddChild<TemplateNode>("anon" + insertPoint->GenerateName(), structType);
+        auto node = insertPoint->AddChild<TemplateNode>(Interner::Intern("anon" + insertPoint->GenerateName()), structType);
         std::vector<llvm::Type *> types;
         for (const auto &val : init.GetValues())
         {
@@ -674,28 +791,28 @@ std::shared_ptr<TemplateCodeType> CodeGeneration::TypeFromObjectInitializer(cons
             {
                 auto value = TypeFromObjectInitializer(val->GetValue());
                 types.push_back(value->type);
-                node->AddChild<VariableNode>(val->GetKey().raw, std::make_shared<CodeValue>(nullptr, value));
+                node->AddChild<VariableNode>(val->GetKey().id, MakeRef<CodeValue>(nullptr, value));
             }
             else
             {
                 auto gen = val->GetValue().CodeGen(*this);
                 types.push_back(gen->type->type);
-                node->AddChild<VariableNode>(val->GetKey().raw, gen);
+                node->AddChild<VariableNode>(val->GetKey().id, gen);
             }
         }
         structType->setBody(types);
-        return std::make_shared<TemplateCodeType>(structType, *node);
+        return MakeRef<TemplateCodeType>(structType, *node);
     }
     return nullptr;
 }
 
-std::shared_ptr<CodeType> CodeGeneration::TypeFromArrayInitializer(const SyntaxNode &object)
+Ref<CodeType> CodeGeneration::TypeFromArrayInitializer(const SyntaxNode &object)
 {
     if (object.GetType() == SyntaxType::ArrayLiteral)
     {
         const auto &init = object.As<ArrayLiteral>();
 
-        std::shared_ptr<CodeType> currentType;
+        Ref<CodeType> currentType;
         uint64_t len = 0;
 
         for (const auto val : init.GetValues())
@@ -727,14 +844,14 @@ std::shared_ptr<CodeType> CodeGeneration::TypeFromArrayInitializer(const SyntaxN
             }
         }
         auto arr = llvm::ArrayType::get(currentType->type, init.GetValues().size());
-        return std::make_shared<ArrayCodeType>(arr, currentType);
+        return GetArrayCodeType(arr, currentType);
         // structType->setBody(types);
         // return std::make_shared<TemplateCodeType>(structType, *node);
     }
     return nullptr;
 }
 
-std::shared_ptr<CodeValue> CodeGeneration::FollowDotChain(const SyntaxNode &node)
+Ref<CodeValue> CodeGeneration::FollowDotChain(const SyntaxNode &node)
 {
 
     if (node.GetType() != SyntaxType::BinaryExpression)
@@ -757,18 +874,18 @@ std::shared_ptr<CodeValue> CodeGeneration::FollowDotChain(const SyntaxNode &node
 
         if (left->value == nullptr)
         {
-            if (auto templ = std::dynamic_pointer_cast<TemplateCodeType>(left->type))
+            if (auto templ = DynamicRefCast<TemplateCodeType>(left->type))
             {
                 const auto &templNode = templ->GetNode();
 
-                auto found = templNode.findSymbol(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().raw);
+                auto found = templNode.findSymbol(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().id);
                 if (found != templNode.children.end())
                 {
                     if (found->second->GetType() == SymbolNodeType::FunctionNode)
                     {
                         if (!found->second->As<FunctionNode>().GetFunction()->GetFunctionType()->IsMember())
                         {
-                            return std::static_pointer_cast<CodeValue>(found->second->As<FunctionNode>().GetFunction());
+                            return StaticRefCast<CodeValue>(found->second->As<FunctionNode>().GetFunction());
                         }
                         else
                         {
@@ -793,42 +910,39 @@ std::shared_ptr<CodeValue> CodeGeneration::FollowDotChain(const SyntaxNode &node
             if (left->type->type->isPointerTy())
             {
                 auto loaded = builder.CreateLoad(left->type->type, left->value);
-                left->type->type = left->type->type->getPointerElementType();
-                left = std::make_shared<CodeValue>(loaded, left->type);
+                left = MakeRef<CodeValue>(loaded, Retype(left->type, left->type->type->getPointerElementType()));
             }
             dotExprBase = left;
 
-            if (auto templ = std::dynamic_pointer_cast<TemplateCodeType>(left->type))
+            if (auto templ = DynamicRefCast<TemplateCodeType>(left->type))
             {
                 const auto &templNode = templ->GetNode();
 
-                auto found = templNode.findSymbol(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().raw);
+                auto found = templNode.findSymbol(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().id);
                 if (found != templNode.children.end())
                 {
                     if (found->second->GetType() == SymbolNodeType::FunctionNode)
                     {
-                        return std::static_pointer_cast<CodeValue>(found->second->As<FunctionNode>().GetFunction());
+                        return StaticRefCast<CodeValue>(found->second->As<FunctionNode>().GetFunction());
                     }
                     else
                     {
                         if (IsUsed(CodeGeneration::Using::Reference)) // Return reference and don't load
                         {
-                            auto index = templNode.IndexOf(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().raw);
+                            auto index = templNode.IndexOf(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().id);
                             auto gep = builder.CreateStructGEP(templ->type, left->value, index);
 
-                            auto value = std::make_shared<CodeValue>(gep, found->second->As<VariableNode>().GetVariable()->type);
+                            auto value = MakeRef<CodeValue>(gep, found->second->As<VariableNode>().GetVariable()->type);
                             // value->type->type = gep->getType();
                             return value;
                         }
                         else // Load value
                         {
-                            auto index = templNode.IndexOf(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().raw);
+                            auto index = templNode.IndexOf(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().id);
                             auto gep = builder.CreateStructGEP(templ->type, left->value, index);
 
                             auto load = builder.CreateLoad(templ->type, gep);
-                            auto value = std::make_shared<CodeValue>(load, found->second->As<VariableNode>().GetVariable()->type);
-                            value->type->type = load->getType();
-                            return value;
+                            return MakeRef<CodeValue>(load, Retype(found->second->As<VariableNode>().GetVariable()->type, load->getType()));
                         }
                     }
                 }
@@ -836,7 +950,7 @@ std::shared_ptr<CodeValue> CodeGeneration::FollowDotChain(const SyntaxNode &node
                 {
                     ThrowCompilerError(
                         ErrorType::FollowDotChain, ErrorCode::CannotFind,
-                        std::string("Cannot find value ") + bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().raw + " in type " + templ->GetNode().GetParent()->findSymbol((SymbolNode *)&templNode),
+                        std::string("Cannot find value ") + std::string(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().raw) + " in type " + templ->GetNode().GetParent()->findSymbol((SymbolNode *)&templNode),
                         Range(bin.GetLHS().GetStart(), bin.GetRHS().GetEnd()));
                 }
             }
@@ -852,31 +966,29 @@ std::shared_ptr<CodeValue> CodeGeneration::FollowDotChain(const SyntaxNode &node
         if (!isReference)
             UnUse(Using::Reference);
 
-        if (auto templ = std::static_pointer_cast<TemplateCodeType>(left->type))
+        if (auto templ = StaticRefCast<TemplateCodeType>(left->type))
         {
             const auto &templNode = templ->GetNode();
-            auto found = templNode.findSymbol(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().raw);
+            auto found = templNode.findSymbol(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().id);
             if (found != templNode.children.end())
             {
                 if (found->second->GetType() == SymbolNodeType::FunctionNode)
                 {
-                    return std::static_pointer_cast<CodeValue>(found->second->As<FunctionNode>().GetFunction());
+                    return StaticRefCast<CodeValue>(found->second->As<FunctionNode>().GetFunction());
                 }
                 else
                 {
-                    auto found = templNode.findSymbol(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().raw);
+                    auto found = templNode.findSymbol(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().id);
                     if (IsUsed(CodeGeneration::Using::Reference)) // Return reference and don't load
                     {
                     }
                     else // Load value
                     {
-                        auto index = templNode.IndexOf(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().raw);
+                        auto index = templNode.IndexOf(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().id);
                         auto gep = builder.CreateStructGEP(templ->type, left->value, index);
 
                         auto load = builder.CreateLoad(templ->type, gep);
-                        auto value = std::make_shared<CodeValue>(load, found->second->As<VariableNode>().GetVariable()->type);
-                        value->type->type = load->getType();
-                        return value;
+                        return MakeRef<CodeValue>(load, Retype(found->second->As<VariableNode>().GetVariable()->type, load->getType()));
                     }
                 }
             }
@@ -884,7 +996,7 @@ std::shared_ptr<CodeValue> CodeGeneration::FollowDotChain(const SyntaxNode &node
             {
                 ThrowCompilerError(
                     ErrorType::FollowDotChain, ErrorCode::CannotFind,
-                    std::string("Cannot find value ") + bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().raw + " in type " + templ->GetNode().GetParent()->findSymbol((SymbolNode *)&templNode),
+                    std::string("Cannot find value ") + std::string(bin.GetRHS().As<IdentifierExpression>().GetIdentiferToken().raw) + " in type " + templ->GetNode().GetParent()->findSymbol((SymbolNode *)&templNode),
                     Range(bin.GetLHS().GetStart(), bin.GetRHS().GetEnd()));
             }
         }
@@ -894,7 +1006,7 @@ std::shared_ptr<CodeValue> CodeGeneration::FollowDotChain(const SyntaxNode &node
 
 void CodeGeneration::GenerateMain()
 {
-    if (auto programMain = dynamic_cast<FunctionNode *>(FindSymbolInScope("main")))
+    if (auto programMain = FindSymbolInScope<FunctionNode>(Interner::Intern("main")))
     {
         std::vector<llvm::Type *> parameters;
         parameters.push_back(llvm::IntegerType::get(context, 32));
@@ -911,9 +1023,353 @@ void CodeGeneration::GenerateMain()
     }
 }
 
+// Runs the default new pass manager pipeline for the level over a whole module. With a target the passes get its
+// cost model instead of the generic one. The pre link pipeline leaves the cross module work to a ThinLTO link
+void CodeGeneration::Optimize(llvm::Module &module, OptimizationLevel level, llvm::TargetMachine *target, bool preLink)
+{
+    llvm::LoopAnalysisManager loopAnalyses;
+    llvm::FunctionAnalysisManager functionAnalyses;
+    llvm::CGSCCAnalysisManager cgsccAnalyses;
+    llvm::ModuleAnalysisManager moduleAnalyses;
+
+    if (target) // Registered first so the defaults below don't replace it
+        functionAnalyses.registerPass([&] { return target->getTargetIRAnalysis(); });
+
+    llvm::PassBuilder passBuilder;
+    passBuilder.registerModuleAnalyses(moduleAnalyses);
+    passBuilder.registerCGSCCAnalyses(cgsccAnalyses);
+    passBuilder.registerFunctionAnalyses(functionAnalyses);
+    passBuilder.registerLoopAnalyses(loopAnalyses);
+    passBuilder.crossRegisterProxies(loopAnalyses, functionAnalyses, cgsccAnalyses, moduleAnalyses);
+
+    auto passLevel = llvm::PassBuilder::OptimizationLevel::O0;
+    switch (level)
+    {
+    case OptimizationLevel::O0:
+        break;
+    case OptimizationLevel::O1:
+        passLevel = llvm::PassBuilder::OptimizationLevel::O1;
+        break;
+    case OptimizationLevel::O2:
+        passLevel = llvm::PassBuilder::OptimizationLevel::O2;
+        break;
+    case OptimizationLevel::O3:
+        passLevel = llvm::PassBuilder::OptimizationLevel::O3;
+        break;
+    case OptimizationLevel::Os:
+        passLevel = llvm::PassBuilder::OptimizationLevel::Os;
+        break;
+    case OptimizationLevel::Oz:
+        passLevel = llvm::PassBuilder::OptimizationLevel::Oz;
+        break;
+    }
+
+    llvm::ModulePassManager passes;
+    if (level == OptimizationLevel::O0)
+        passes = passBuilder.buildO0DefaultPipeline(passLevel);
+    else if (preLink)
+        passes = passBuilder.buildThinLTOPreLinkDefaultPipeline(passLevel);
+    else
+        passes = passBuilder.buildPerModuleDefaultPipeline(passLevel);
+
+    passes.run(module, moduleAnalyses);
+}
+
+// Features of the host cpu in the "+feature" form subtarget feature strings use
+std::vector<std::string> CodeGeneration::HostFeatures()
+{
+    llvm::SubtargetFeatures features;
+    llvm::StringMap<bool> hostFeatures;
+    if (llvm::sys::getHostCPUFeatures(hostFeatures))
+        for (auto &feature : hostFeatures)
+            features.AddFeature(feature.first(), feature.second);
+    return features.getFeatures();
+}
+
+llvm::CodeGenOpt::Level CodeGeneration::CodeGenLevel(OptimizationLevel level)
+{
+    switch (level)
+    {
+    case OptimizationLevel::O0:
+        return llvm::CodeGenOpt::None;
+    case OptimizationLevel::O1:
+        return llvm::CodeGenOpt::Less;
+    case OptimizationLevel::O3:
+        return llvm::CodeGenOpt::Aggressive;
+    default:
+        return llvm::CodeGenOpt::Default;
+    }
+}
+
+// Target machine for the host triple, tuned for the host cpu and the features it reports
+std::unique_ptr<llvm::TargetMachine> CodeGeneration::CreateHostTargetMachine(OptimizationLevel level)
+{
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    auto targetTriple = llvm::sys::getDefaultTargetTriple();
+
+    std::string error;
+    auto target = llvm::TargetRegistry::lookupTarget(targetTriple, error);
+    if (!target)
+    {
+        llvm::errs() << error << "\n";
+        return nullptr;
+    }
+
+    llvm::SubtargetFeatures features;
+    for (auto &feature : HostFeatures())
+        features.AddFeature(feature);
+
+    llvm::TargetOptions options;
+    return std::unique_ptr<llvm::TargetMachine>(target->createTargetMachine(targetTriple, llvm::sys::getHostCPUName(), features.getString(),
+                                                                            options, llvm::Reloc::PIC_, llvm::None, CodeGenLevel(level)));
+}
+
+// Must be set before generating code so it and the passes see the target's data layout
+void CodeGeneration::SetTarget(const llvm::TargetMachine &target)
+{
+    module->setDataLayout(target.createDataLayout());
+    module->setTargetTriple(target.getTargetTriple().str());
+}
+
+// Writes the module as an object file or assembly for the target
+bool CodeGeneration::EmitFile(llvm::TargetMachine &target, const std::string &filename, llvm::CodeGenFileType type)
+{
+    std::error_code error;
+    llvm::raw_fd_ostream dest(filename, error);
+    if (error)
+    {
+        llvm::errs() << "Could not open file: " << error.message() << "\n";
+        return false;
+    }
+
+    llvm::legacy::PassManager passes;
+    if (target.addPassesToEmitFile(passes, dest, nullptr, type))
+    {
+        llvm::errs() << "TargetMachine can't emit a file of this type\n";
+        return false;
+    }
+
+    passes.run(*module);
+    dest.flush();
+    return true;
+}
+
+// Gives the module and the context it lives in to the caller. Nothing can be generated afterwards and the types
+// and values in the symbol tree belong to the returned module
+llvm::orc::ThreadSafeModule CodeGeneration::TakeModule()
+{
+    auto taken = std::unique_ptr<llvm::Module>(module);
+    module = nullptr;
+    return llvm::orc::ThreadSafeModule(std::move(taken), std::move(contextOwner));
+}
+
+// Writes the module as bitcode with its ThinLTO summary, which lets a thin link decide what to import without
+// loading the module
+void CodeGeneration::WriteBitcode(llvm::raw_ostream &stream)
+{
+    llvm::ProfileSummaryInfo profile(*module);
+    auto summary = llvm::buildModuleSummaryIndex(*module, nullptr, &profile);
+    llvm::WriteBitcodeToFile(*module, stream, false, &summary);
+}
+
+// Sorts the top level statements into worklists in one run over the root's children in the flat tree. Types are only
+// declared here, their members, functions and actions are resolved the first time FindSymbolInScope reaches them
+void CodeGeneration::PreCodeGen(const FlatTree &tree)
+{
+    tree.ForEachChild(FlatTree::Root, [&](FlatTree::Index statement) {
+        switch (tree.Kind(statement))
+        {
+        case SyntaxType::TemplateStatement:
+        case SyntaxType::SpecStatement:
+        case SyntaxType::TypeAliasStatement:
+            typeDeclarations.push_back(&tree.Node(statement));
+            break;
+        case SyntaxType::ActionBaseStatement:
+        case SyntaxType::ActionSpecStatement:
+            actionDeclarations.push_back(&tree.Node(statement));
+            break;
+        case SyntaxType::FunctionDeclerationStatement:
+            functionDeclarations.push_back(&tree.Node(statement));
+            break;
+        default:
+            break;
+        }
+    });
+
+    preCodeGenPass = 0; // All types
+    for (auto declaration : typeDeclarations)
+        declaration->PreCodeGen(*this);
+
+    // Actions wait on the template they extend, anything else is resolved now so its errors are still reported
+    std::vector<const SyntaxNode *> unfiled;
+    for (auto action : actionDeclarations)
+    {
+        const SyntaxNode *t = action->GetType() == SyntaxType::ActionBaseStatement
+                                  ? &action->As<ActionBaseStatement>().GetTemplateType()
+                                  : &action->As<ActionSpecStatement>().GetTemplateType();
+        while (t->GetType() == SyntaxType::GenericType)
+            t = t->As<GenericType>().GetBaseType();
+
+        auto templ = t->GetType() == SyntaxType::IdentifierType ? dyn_cast_or_null<TemplateNode>(LookupSymbol(t->As<IdentifierType>().GetToken().id)) : nullptr;
+        if (templ && templ->IsDeferred())
+            templ->AddAction(action);
+        else
+            unfiled.push_back(action);
+    }
+    ResolveActions(unfiled);
+
+    preCodeGenPass = 30; // Functions
+    for (auto declaration : functionDeclarations)
+        declaration->PreCodeGen(*this);
+}
+
+// Runs the passes a declaration skipped in PreCodeGen. The lookup can come from the middle of another
+// declaration or function body, so the state the passes change is saved and they see it as they did up front
+void CodeGeneration::Resolve(SymbolNode *symbol)
+{
+    auto declaration = symbol->declaration;
+    symbol->Defer(nullptr); // Resolved before the passes run so a type can refer to itself
+
+    auto lastPoint = insertPoint;
+    auto lastType = currentType;
+    auto lastVar = currentVar;
+    auto lastUsings = usings;
+    auto lastPass = preCodeGenPass;
+    auto lastBlock = builder.saveIP();
+
+    insertPoint = symbol->GetParent();
+    usings.reset();
+    builder.ClearInsertionPoint();
+
+    switch (symbol->GetType())
+    {
+    case SymbolNodeType::TypeAliasNode:
+        preCodeGenPass = 1; // Alias target
+        declaration->PreCodeGen(*this);
+        break;
+    case SymbolNodeType::TemplateNode:
+        preCodeGenPass = 10; // Template members
+        declaration->PreCodeGen(*this);
+        ResolveActions(cast<TemplateNode>(symbol)->GetActions());
+        break;
+    case SymbolNodeType::SpecNode:
+        preCodeGenPass = 20; // Spec functions
+        declaration->PreCodeGen(*this);
+        break;
+    default:
+        break;
+    }
+
+    insertPoint = lastPoint;
+    currentType = lastType;
+    currentVar = lastVar;
+    usings = lastUsings;
+    preCodeGenPass = lastPass;
+    builder.restoreIP(lastBlock);
+}
+
+// Declares the functions of the actions and queues their bodies for GenerateDeferred
+void CodeGeneration::ResolveActions(const std::vector<const SyntaxNode *> &actions)
+{
+    auto lastPass = preCodeGenPass;
+
+    preCodeGenPass = 20; // Action functions
+    for (auto action : actions)
+        if (action->GetType() == SyntaxType::ActionBaseStatement)
+            action->PreCodeGen(*this);
+
+    preCodeGenPass = 30; // Spec implementations
+    for (auto action : actions)
+        if (action->GetType() == SyntaxType::ActionSpecStatement)
+            action->PreCodeGen(*this);
+
+    preCodeGenPass = lastPass;
+    deferredDefinitions.insert(deferredDefinitions.end(), actions.begin(), actions.end());
+}
+
+void CodeGeneration::GenerateDeferred()
+{
+    Use(Using::Deferred);
+
+    // Generating a body can resolve more templates, which queue their own actions
+    for (size_t i = 0; i < deferredDefinitions.size(); i++)
+        deferredDefinitions[i]->CodeGen(*this);
+
+    UnUse(Using::Deferred);
+}
+
+// Partitions only generate the bodies they own, so every one of them has to declare the same functions and
+// queue the same actions whatever their own bodies happen to use
+void CodeGeneration::ResolveAll()
+{
+    auto &children = insertPoint->GetChildren();
+    for (size_t i = 0; i < children.size(); i++) // Resolving can add generic instances to the scope
+    {
+        auto symbol = (children.begin() + i)->second;
+        if (symbol->IsDeferred())
+            Resolve(symbol);
+    }
+}
+
+// Module level variables. Every partition generates the whole tree but only the first one defines the storage, the
+// others declare it so all of their functions share one variable once they are linked
+llvm::GlobalVariable *CodeGeneration::CreateGlobal(llvm::Type *type, bool constant, llvm::Constant *initializer, const std::string &name)
+{
+    llvm::GlobalVariable *global;
+    if (partition > 0)
+        global = new llvm::GlobalVariable(*module, type, constant, llvm::GlobalValue::ExternalLinkage, nullptr, name);
+    else
+        global = new llvm::GlobalVariable(*module, type, constant, IsUsed(Using::Export) ? llvm::GlobalValue::ExternalLinkage : llvm::GlobalValue::PrivateLinkage, initializer, name);
+
+    global->setAlignment(module->getDataLayout().getPrefTypeAlign(type));
+    return global;
+}
+
+// A partition refers to functions and variables defined in another partition's module, so private definitions stay
+// external until the partitions are linked. Returns their names for InternalizeGlobals
+std::vector<std::string> CodeGeneration::ExternalizeGlobals()
+{
+    std::vector<std::string> names;
+    for (auto &global : module->global_values())
+    {
+        if (global.hasPrivateLinkage())
+        {
+            names.push_back(global.getName().str());
+            global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+        }
+    }
+    return names;
+}
+
+void CodeGeneration::InternalizeGlobals(const std::vector<std::string> &names)
+{
+    for (auto &name : names)
+        if (auto global = module->getNamedValue(name))
+            global->setLinkage(llvm::GlobalValue::PrivateLinkage);
+}
+
+// Loads the bitcode of a partition generated in another context and links it into this module
+bool CodeGeneration::LinkPartition(llvm::StringRef bitcode)
+{
+    auto partitionModule = llvm::parseBitcodeFile(llvm::MemoryBufferRef(bitcode, module->getName()), context);
+    if (!partitionModule)
+    {
+        llvm::logAllUnhandledErrors(partitionModule.takeError(), llvm::errs(), "Unable to load partition: ");
+        return false;
+    }
+    return !llvm::Linker::linkModules(*module, std::move(*partitionModule));
+}
+
 namespace Parsing
 {
-    std::shared_ptr<CodeValue> VariableDeclerationStatement::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> SyntaxNode::CodeGen(CodeGeneration &gen) const
+    {
+        return nullptr;
+    }
+
+    Ref<CodeValue> VariableDeclerationStatement::CodeGen(CodeGeneration &gen) const
     {
         if (initializer && initializer->GetType() == SyntaxType::TemplateInitializer)
         {
@@ -927,13 +1383,13 @@ namespace Parsing
             }
             else if (keyword.type == TokenType::Let)
             {
-                auto inst = gen.CreateEntryBlockAlloca(type->type, identifier.raw); // Allocate the variable on the stack
+                auto inst = gen.CreateEntryBlockAlloca(type->type, std::string(identifier.raw)); // Allocate the variable on the stack
 
-                auto varValue = std::make_shared<CodeValue>(inst, type);
+                auto varValue = MakeRef<CodeValue>(inst, type);
                 gen.SetCurrentVar(varValue);
                 initializer->CodeGen(gen);
 
-                gen.GetInsertPoint()->AddChild<VariableNode>(identifier.raw, varValue); // Insert variable into symbol tree
+                gen.GetInsertPoint()->AddChild<VariableNode>(identifier.id, varValue); // Insert variable into symbol tree
                 return varValue;
             }
         }
@@ -947,14 +1403,14 @@ namespace Parsing
                 else if (keyword.type == TokenType::Let)
                 {
                     auto type = gen.TypeFromObjectInitializer(*initializer);
-                    auto inst = gen.CreateEntryBlockAlloca(type->type, identifier.raw); // Allocate the variable on the stack
+                    auto inst = gen.CreateEntryBlockAlloca(type->type, std::string(identifier.raw)); // Allocate the variable on the stack
 
-                    auto varValue = std::make_shared<CodeValue>(inst, type);
+                    auto varValue = MakeRef<CodeValue>(inst, type);
                     gen.SetCurrentVar(varValue);
 
                     initializer->CodeGen(gen);
 
-                    gen.GetInsertPoint()->AddChild<VariableNode>(identifier.raw, varValue); // Insert variable into symbol tree
+                    gen.GetInsertPoint()->AddChild<VariableNode>(identifier.id, varValue); // Insert variable into symbol tree
                     return varValue;
                 }
             }
@@ -966,14 +1422,14 @@ namespace Parsing
                 else if (keyword.type == TokenType::Let)
                 {
                     auto type = gen.TypeType(*this->type);
-                    auto inst = gen.CreateEntryBlockAlloca(type->type, identifier.raw); // Allocate the variable on the stack
+                    auto inst = gen.CreateEntryBlockAlloca(type->type, std::string(identifier.raw)); // Allocate the variable on the stack
 
-                    auto varValue = std::make_shared<CodeValue>(inst, type);
+                    auto varValue = MakeRef<CodeValue>(inst, type);
                     gen.SetCurrentVar(varValue);
 
                     initializer->CodeGen(gen);
 
-                    gen.GetInsertPoint()->AddChild<VariableNode>(identifier.raw, varValue); // Insert variable into symbol tree
+                    gen.GetInsertPoint()->AddChild<VariableNode>(identifier.id, varValue); // Insert variable into symbol tree
                     return varValue;
                 }
                 return nullptr;
@@ -989,14 +1445,14 @@ namespace Parsing
                 else if (keyword.type == TokenType::Let)
                 {
                     auto type = gen.TypeFromArrayInitializer(*initializer);
-                    auto inst = gen.CreateEntryBlockAlloca(type->type, identifier.raw); // Allocate the variable on the stack
+                    auto inst = gen.CreateEntryBlockAlloca(type->type, std::string(identifier.raw)); // Allocate the variable on the stack
 
-                    auto varValue = std::make_shared<CodeValue>(inst, type);
+                    auto varValue = MakeRef<CodeValue>(inst, type);
                     gen.SetCurrentVar(varValue);
 
                     initializer->CodeGen(gen);
 
-                    gen.GetInsertPoint()->AddChild<VariableNode>(identifier.raw, varValue); // Insert variable into symbol tree
+                    gen.GetInsertPoint()->AddChild<VariableNode>(identifier.id, varValue); // Insert variable into symbol tree
                     return varValue;
                 }
             }
@@ -1007,14 +1463,14 @@ namespace Parsing
                 }
                 else if (keyword.type == TokenType::Let)
                 {
-                    auto inst = gen.CreateEntryBlockAlloca(gen.TypeType(*this->type)->type, identifier.raw); // Allocate the variable on the stack
+                    auto inst = gen.CreateEntryBlockAlloca(gen.TypeType(*this->type)->type, std::string(identifier.raw)); // Allocate the variable on the stack
 
-                    auto varValue = std::make_shared<CodeValue>(inst, gen.TypeType(*this->type));
+                    auto varValue = MakeRef<CodeValue>(inst, gen.TypeType(*this->type));
                     gen.SetCurrentVar(varValue);
 
                     initializer->CodeGen(gen);
 
-                    gen.GetInsertPoint()->AddChild<VariableNode>(identifier.raw, varValue); // Insert variable into symbol tree
+                    gen.GetInsertPoint()->AddChild<VariableNode>(identifier.id, varValue); // Insert variable into symbol tree
                     return varValue;
                 }
                 return nullptr;
@@ -1023,7 +1479,7 @@ namespace Parsing
         else
         {
             auto init = initializer ? initializer->CodeGen(gen) : nullptr;
-            std::shared_ptr<CodeType> type;
+            Ref<CodeType> type;
             if (initializer && !this->type)
                 type = init->type;
             else if (this->type)
@@ -1042,13 +1498,10 @@ namespace Parsing
                 {
                     if (llvm::isa<llvm::Constant>(init->value))
                     {
-                        auto global = new llvm::GlobalVariable(gen.GetModule(), type->type, true, gen.IsUsed(CodeGeneration::Using::Export) ? llvm::GlobalValue::LinkageTypes::ExternalLinkage : llvm::GlobalValue::LinkageTypes::PrivateLinkage, static_cast<llvm::Constant *>(init->value), gen.GenerateMangledName(identifier.raw));
-                        const llvm::DataLayout &DL = gen.GetModule().getDataLayout();
-                        llvm::Align AllocaAlign = DL.getPrefTypeAlign(type->type);
-                        global->setAlignment(AllocaAlign);
+                        auto global = gen.CreateGlobal(type->type, true, static_cast<llvm::Constant *>(init->value), gen.GenerateMangledName(identifier.raw));
 
-                        auto varValue = std::make_shared<CodeValue>(global, type);
-                        gen.GetInsertPoint()->AddChild<VariableNode>(identifier.raw, varValue);
+                        auto varValue = MakeRef<CodeValue>(global, type);
+                        gen.GetInsertPoint()->AddChild<VariableNode>(identifier.id, varValue);
                     }
                     else
                     {
@@ -1062,13 +1515,10 @@ namespace Parsing
                 {
                     if (llvm::isa<llvm::Constant>(init->value))
                     {
-                        auto global = new llvm::GlobalVariable(gen.GetModule(), type->type, false, gen.IsUsed(CodeGeneration::Using::Export) ? llvm::GlobalValue::LinkageTypes::ExternalLinkage : llvm::GlobalValue::LinkageTypes::PrivateLinkage, static_cast<llvm::Constant *>(init->value), gen.GenerateMangledName(identifier.raw));
-                        const llvm::DataLayout &DL = gen.GetModule().getDataLayout();
-                        llvm::Align AllocaAlign = DL.getPrefTypeAlign(type->type);
-                        global->setAlignment(AllocaAlign);
+                        auto global = gen.CreateGlobal(type->type, false, static_cast<llvm::Constant *>(init->value), gen.GenerateMangledName(identifier.raw));
 
-                        auto varValue = std::make_shared<CodeValue>(global, type);
-                        gen.GetInsertPoint()->AddChild<VariableNode>(identifier.raw, varValue);
+                        auto varValue = MakeRef<CodeValue>(global, type);
+                        gen.GetInsertPoint()->AddChild<VariableNode>(identifier.id, varValue);
                     }
                     else
                     {
@@ -1086,17 +1536,17 @@ namespace Parsing
                     if (init)
                     {
 
-                        std::shared_ptr<CodeValue> varValue;
+                        Ref<CodeValue> varValue;
                         if (type) // If type is specified cast the value to the type
                         {
                             gen.SetCurrentRange(Range(this->type->GetStart(), initializer->GetEnd()));
                             auto casted = gen.Cast(init, type);
-                            varValue = std::make_shared<CodeValue>(casted->value, type);
+                            varValue = MakeRef<CodeValue>(casted->value, type);
                         }
                         else
-                            varValue = std::make_shared<CodeValue>(init->value, type);
+                            varValue = MakeRef<CodeValue>(init->value, type);
 
-                        gen.GetInsertPoint()->AddChild<VariableNode>(identifier.raw, varValue); // Insert variable into symbol tree
+                        gen.GetInsertPoint()->AddChild<VariableNode>(identifier.id, varValue); // Insert variable into symbol tree
                         return varValue;
                     }
                     else
@@ -1109,7 +1559,7 @@ namespace Parsing
                 }
                 else if (keyword.type == TokenType::Let)
                 {
-                    auto inst = gen.CreateEntryBlockAlloca(type->type, identifier.raw); // Allocate the variable on the stack
+                    auto inst = gen.CreateEntryBlockAlloca(type->type, std::string(identifier.raw)); // Allocate the variable on the stack
 
                     if (initializer)
                     {
@@ -1124,8 +1574,8 @@ namespace Parsing
                             gen.GetBuilder().CreateStore(init->value, inst);
                     }
 
-                    auto varValue = std::make_shared<CodeValue>(inst, type);
-                    gen.GetInsertPoint()->AddChild<VariableNode>(identifier.raw, varValue); // Insert variable into symbol tree
+                    auto varValue = MakeRef<CodeValue>(inst, type);
+                    gen.GetInsertPoint()->AddChild<VariableNode>(identifier.id, varValue); // Insert variable into symbol tree
                     return varValue;
                 }
             }
@@ -1133,10 +1583,10 @@ namespace Parsing
             {
                 auto &tn = gen.GetInsertPoint()->As<TemplateNode>();
                 if (!tn.IsGeneric())
-                    tn.AddMember(type->type, identifier.raw);
+                    tn.AddMember(type->type, identifier.id);
 
-                auto val = std::make_shared<CodeValue>(nullptr, type);
-                gen.GetInsertPoint()->AddChild<VariableNode>(identifier.raw, val);
+                auto val = MakeRef<CodeValue>(nullptr, type);
+                gen.GetInsertPoint()->AddChild<VariableNode>(identifier.id, val);
                 return val;
             }
         }
@@ -1144,7 +1594,7 @@ namespace Parsing
         return nullptr;
     }
 
-    std::shared_ptr<CodeValue> BinaryExpression::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> BinaryExpression::CodeGen(CodeGeneration &gen) const
     {
         if (op.type == TokenType::Dot)
             return gen.FollowDotChain(*this);
@@ -1160,7 +1610,7 @@ namespace Parsing
         auto right = RHS->CodeGen(gen);
         if (left && right && (left->type->type == right->type->type || (left->type->type->getTypeID() == llvm::Type::IntegerTyID && right->type->type->getTypeID() == llvm::Type::IntegerTyID)))
         {
-            auto ret = std::make_shared<CodeValue>(nullptr, std::make_shared<CodeType>(*left->type));
+            auto ret = MakeRef<CodeValue>(nullptr, gen.GetCodeType(*left->type));
             switch (op.type)
             {
             case TokenType::Plus:
@@ -1315,11 +1765,11 @@ namespace Parsing
                 case llvm::Type::FloatTyID:
                 case llvm::Type::DoubleTyID:
                     ret->value = gen.GetBuilder().CreateFCmpOEQ(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::IntegerTyID:
                     ret->value = gen.GetBuilder().CreateICmpEQ(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::StructTyID:
                     //  TODO operator overloading
@@ -1336,11 +1786,11 @@ namespace Parsing
                 case llvm::Type::FloatTyID:
                 case llvm::Type::DoubleTyID:
                     ret->value = gen.GetBuilder().CreateFCmpUNE(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::IntegerTyID:
                     ret->value = gen.GetBuilder().CreateICmpNE(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::StructTyID:
                     //  TODO operator overloading
@@ -1357,14 +1807,14 @@ namespace Parsing
                 case llvm::Type::FloatTyID:
                 case llvm::Type::DoubleTyID:
                     ret->value = gen.GetBuilder().CreateFCmpOLT(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::IntegerTyID:
                     if (left->type->isSigned)
                         ret->value = gen.GetBuilder().CreateICmpSLT(left->value, right->value);
                     else
                         ret->value = gen.GetBuilder().CreateICmpULT(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::StructTyID:
                     //  TODO operator overloading
@@ -1381,14 +1831,14 @@ namespace Parsing
                 case llvm::Type::FloatTyID:
                 case llvm::Type::DoubleTyID:
                     ret->value = gen.GetBuilder().CreateFCmpOLE(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::IntegerTyID:
                     if (left->type->isSigned)
                         ret->value = gen.GetBuilder().CreateICmpSLE(left->value, right->value);
                     else
                         ret->value = gen.GetBuilder().CreateICmpULE(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::StructTyID:
                     //  TODO operator overloading
@@ -1405,14 +1855,14 @@ namespace Parsing
                 case llvm::Type::FloatTyID:
                 case llvm::Type::DoubleTyID:
                     ret->value = gen.GetBuilder().CreateFCmpOGT(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::IntegerTyID:
                     if (left->type->isSigned)
                         ret->value = gen.GetBuilder().CreateICmpSGT(left->value, right->value);
                     else
                         ret->value = gen.GetBuilder().CreateICmpUGT(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::StructTyID:
                     //  TODO operator overloading
@@ -1429,14 +1879,14 @@ namespace Parsing
                 case llvm::Type::FloatTyID:
                 case llvm::Type::DoubleTyID:
                     ret->value = gen.GetBuilder().CreateFCmpOGE(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::IntegerTyID:
                     if (left->type->isSigned)
                         ret->value = gen.GetBuilder().CreateICmpSGE(left->value, right->value);
                     else
                         ret->value = gen.GetBuilder().CreateICmpUGE(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::StructTyID:
                     //  TODO operator overloading
@@ -1454,14 +1904,14 @@ namespace Parsing
                 case llvm::Type::FloatTyID:
                 case llvm::Type::DoubleTyID:
                     ret->value = gen.GetBuilder().CreateFCmpOLE(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::IntegerTyID:
                     if (left->type->isSigned)
                         ret->value = gen.GetBuilder().CreateICmpSLE(left->value, right->value);
                     else
                         ret->value = gen.GetBuilder().CreateICmpULE(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::StructTyID:
                     //  TODO operator overloading
@@ -1479,14 +1929,14 @@ namespace Parsing
                 case llvm::Type::FloatTyID:
                 case llvm::Type::DoubleTyID:
                     ret->value = gen.GetBuilder().CreateFCmpOGE(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::IntegerTyID:
                     if (left->type->isSigned)
                         ret->value = gen.GetBuilder().CreateICmpSGE(left->value, right->value);
                     else
                         ret->value = gen.GetBuilder().CreateICmpUGE(left->value, right->value);
-                    ret->type->type = ret->value->getType();
+                    ret->type = gen.Retype(ret->type, ret->value->getType());
                     break;
                 case llvm::Type::StructTyID:
                     //  TODO operator overloading
@@ -1590,14 +2040,14 @@ namespace Parsing
         return nullptr;
     }
 
-    std::shared_ptr<CodeValue> UnaryExpression::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> UnaryExpression::CodeGen(CodeGeneration &gen) const
     {
         if (op.type == TokenType::Ampersand)
             gen.Use(CodeGeneration::Using::Reference);
         auto expr = expression->CodeGen(gen);
         if (op.type == TokenType::Ampersand)
             gen.UnUse(CodeGeneration::Using::Reference);
-        auto ret = std::make_shared<CodeValue>(nullptr, std::make_shared<CodeType>(*expr->type));
+        auto ret = MakeRef<CodeValue>(nullptr, gen.GetCodeType(*expr->type));
         switch (op.type)
         {
         case TokenType::Minus:
@@ -1693,7 +2143,7 @@ namespace Parsing
                 // llvm::Instruction::AddrSpaceCast
                 // expr->value->getType()->getPointerTo->print(llvm::outs());
                 ret->value = expr->value;
-                ret->type->type = expr->type->type->getPointerTo();
+                ret->type = gen.Retype(ret->type, expr->type->type->getPointerTo());
             }
             // switch (expr->type->type->getTypeID())
             // {
@@ -1711,14 +2161,14 @@ namespace Parsing
         return ret;
     }
 
-    std::shared_ptr<CodeValue> PostfixExpression::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> PostfixExpression::CodeGen(CodeGeneration &gen) const
     {
         return nullptr;
     }
 
-    std::shared_ptr<CodeValue> IdentifierExpression::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> IdentifierExpression::CodeGen(CodeGeneration &gen) const
     {
-        const auto found = gen.FindSymbolInScope(identifierToken.raw);
+        const auto found = gen.FindSymbolInScope(identifierToken.id);
         if (found != nullptr)
         {
             switch (found->GetType())
@@ -1733,9 +2183,7 @@ namespace Parsing
                 else
                 {
                     auto load = gen.GetBuilder().CreateLoad(f->type->type, f->value);
-                    auto value = std::make_shared<CodeValue>(load, f->type);
-                    value->type->type = load->getType();
-                    return value;
+                    return MakeRef<CodeValue>(load, gen.Retype(f->type, load->getType()));
                 }
             }
             case SymbolNodeType::FunctionNode:
@@ -1748,7 +2196,7 @@ namespace Parsing
             {
                 auto t = found->As<TemplateNode>().GetTemplate();
                 // f->type->type = f->value->getType();
-                return std::make_shared<CodeValue>(nullptr, t);
+                return MakeRef<CodeValue>(nullptr, t);
             }
             default:
                 break;
@@ -1756,14 +2204,14 @@ namespace Parsing
         }
         ThrowCompilerError(
             ErrorType::IdentifierExpression, ErrorCode::CannotFind,
-            "Symbol " + identifierToken.raw + " was not found in scope!",
+            "Symbol " + std::string(identifierToken.raw) + " was not found in scope!",
             Range(identifierToken.GetStart(), identifierToken.GetEnd()));
         return nullptr;
     }
 
-    std::shared_ptr<CodeValue> CallExpression::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> CallExpression::CodeGen(CodeGeneration &gen) const
     {
-        auto fnExpr = std::static_pointer_cast<FunctionCodeValue>(fn->CodeGen(gen));
+        auto fnExpr = StaticRefCast<FunctionCodeValue>(fn->CodeGen(gen));
         if (fnExpr)
         {
             size_t argSize = arguments.size();
@@ -1801,12 +2249,12 @@ namespace Parsing
             }
             auto call = gen.GetBuilder().CreateCall(fnExpr->Function(), args);
 
-            auto funcType = std::static_pointer_cast<FunctionCodeType>(fnExpr->type);
+            auto funcType = StaticRefCast<FunctionCodeType>(fnExpr->type);
 
-            if (auto templ = std::dynamic_pointer_cast<TemplateCodeType>(funcType->GetReturnType()))
-                return std::make_shared<CodeValue>(call, templ);
+            if (auto templ = DynamicRefCast<TemplateCodeType>(funcType->GetReturnType()))
+                return MakeRef<CodeValue>(call, templ);
             else
-                return std::make_shared<CodeValue>(call, fnExpr->type);
+                return MakeRef<CodeValue>(call, fnExpr->type);
         }
         ThrowCompilerError(
             ErrorType::FunctionCall, ErrorCode::NonFunction,
@@ -1815,7 +2263,7 @@ namespace Parsing
         return nullptr;
     }
 
-    std::shared_ptr<CodeValue> SubscriptExpression::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> SubscriptExpression::CodeGen(CodeGeneration &gen) const
     {
         bool isReference = gen.IsUsed(CodeGeneration::Using::Reference);
         gen.Use(CodeGeneration::Using::Reference);
@@ -1833,9 +2281,9 @@ namespace Parsing
             auto gep = gen.GetBuilder().CreateInBoundsGEP(expression->value, idxs);
             // auto gep = gen.GetBuilder().CreateConstInBoundsGEP2_32(nullptr, expression->value, subscript->value);
             if (isReference)
-                return std::make_shared<CodeValue>(gep, std::dynamic_pointer_cast<ArrayCodeType>(expression->type)->GetBaseType());
+                return MakeRef<CodeValue>(gep, DynamicRefCast<ArrayCodeType>(expression->type)->GetBaseType());
             else
-                return std::make_shared<CodeValue>(gen.GetBuilder().CreateLoad(expression->type->type, gep), std::dynamic_pointer_cast<ArrayCodeType>(expression->type)->GetBaseType());
+                return MakeRef<CodeValue>(gen.GetBuilder().CreateLoad(expression->type->type, gep), DynamicRefCast<ArrayCodeType>(expression->type)->GetBaseType());
         }
         else
         {
@@ -1846,18 +2294,18 @@ namespace Parsing
         }
     }
 
-    std::shared_ptr<CodeValue> CastExpression::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> CastExpression::CodeGen(CodeGeneration &gen) const
     {
         auto type = gen.TypeType(*this->type);
         auto expr = this->LHS->CodeGen(gen);
         return gen.Cast(expr, type, false);
     }
 
-    std::shared_ptr<CodeValue> ArrayLiteral::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> ArrayLiteral::CodeGen(CodeGeneration &gen) const
     {
         // auto type = static_cast<llvm::ArrayType *>(gen.LiteralType(*this)->type);
         llvm::Value *strc = nullptr;
-        std::shared_ptr<CodeType> type;
+        Ref<CodeType> type;
         if (gen.GetCurrentVar())
         {
             strc = gen.GetCurrentVar()->value;
@@ -1869,7 +2317,7 @@ namespace Parsing
             strc = gen.CreateEntryBlockAlloca(type->type, "");
         }
 
-        if (auto arrType = std::dynamic_pointer_cast<ArrayCodeType>(type))
+        if (auto arrType = DynamicRefCast<ArrayCodeType>(type))
         {
             int index = 0;
 
@@ -1907,14 +2355,14 @@ namespace Parsing
             gen.SetCurrentVar(tempCurr);
 
             if (!gen.GetCurrentVar())
-                return std::make_shared<CodeValue>(gen.GetBuilder().CreateLoad(type->type, strc), type);
+                return MakeRef<CodeValue>(gen.GetBuilder().CreateLoad(type->type, strc), type);
         }
         // std::vector<const llvm::Value *> vals;
 
         return nullptr;
     }
 
-    std::shared_ptr<CodeValue> StringSyntax::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> StringSyntax::CodeGen(CodeGeneration &gen) const
     {
         auto type = gen.LiteralType(*this);
         std::vector<llvm::Constant *> vals;
@@ -1923,7 +2371,7 @@ namespace Parsing
             vals.push_back(llvm::ConstantInt::get(llvm::Type::getInt8Ty(gen.GetContext()), c));
         }
         vals.push_back(llvm::ConstantInt::get(llvm::Type::getInt8Ty(gen.GetContext()), 0));
-        return std::make_shared<CodeValue>(llvm::ConstantArray::get(static_cast<llvm::ArrayType *>(type->type), llvm::makeArrayRef(vals)), type);
+        return MakeRef<CodeValue>(llvm::ConstantArray::get(static_cast<llvm::ArrayType *>(type->type), llvm::makeArrayRef(vals)), type);
     }
 
     // std::shared_ptr<CodeValue> CharSyntax::CodeGen(CodeGeneration &gen) const
@@ -1932,34 +2380,37 @@ namespace Parsing
     //     return std::make_shared<CodeValue>(llvm::ConstantArray::get(static_cast<llvm::ArrayType *>(type->type), llvm::makeArrayRef(vals)), type);
     // }
 
-    std::shared_ptr<CodeValue> BooleanSyntax::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> BooleanSyntax::CodeGen(CodeGeneration &gen) const
     {
         auto type = gen.LiteralType(*this);
-        return std::make_shared<CodeValue>(llvm::ConstantInt::get(type->type, llvm::APInt(1, GetValue())), type);
+        return MakeRef<CodeValue>(llvm::ConstantInt::get(type->type, llvm::APInt(1, GetValue())), type);
     }
 
-    std::shared_ptr<CodeValue> FloatingSyntax::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> FloatingSyntax::CodeGen(CodeGeneration &gen) const
     {
         auto type = gen.LiteralType(*this);
-        return std::make_shared<CodeValue>(llvm::ConstantFP::get(type->type, llvm::APFloat(GetValue())), type);
+        return MakeRef<CodeValue>(llvm::ConstantFP::get(type->type, llvm::APFloat(GetValue())), type);
     }
 
-    std::shared_ptr<CodeValue> IntegerSyntax::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> IntegerSyntax::CodeGen(CodeGeneration &gen) const
     {
         auto type = gen.LiteralType(*this);
-        return std::make_shared<CodeValue>(llvm::ConstantInt::get(type->type, llvm::APInt(CodeGeneration::GetNumBits(GetValue()), GetValue())), type);
+        return MakeRef<CodeValue>(llvm::ConstantInt::get(type->type, llvm::APInt(CodeGeneration::GetNumBits(GetValue()), GetValue())), type);
     }
 
-    std::shared_ptr<CodeValue> FunctionDeclerationStatement::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> FunctionDeclerationStatement::CodeGen(CodeGeneration &gen) const
     {
         auto checkFunc = gen.GetModule().getFunction(gen.GenerateMangledName(identifier.raw));
-        auto found = gen.GetInsertPoint()->findSymbol(identifier.raw);
+        if (!gen.OwnsBody(checkFunc)) // Generated by another partition
+            return nullptr;
+
+        auto found = gen.GetInsertPoint()->findSymbol(identifier.id);
 
         if (!checkFunc->empty())
         {
             ThrowCompilerError(
                 ErrorType::FunctionDecleration, ErrorCode::AlreadyFound,
-                "Function or type with name " + identifier.raw + " was already found in scope!",
+                "Function or type with name " + std::string(identifier.raw) + " was already found in scope!",
                 Range(GetStart(), GetEnd()));
         }
 
@@ -1985,12 +2436,12 @@ namespace Parsing
         int index = 0;
         for (auto &arg : checkFunc->args())
         {
-            auto inst = gen.CreateEntryBlockAlloca(arg.getType(), this->parameters[index]->GetIdentifier().raw); // Allocate the variable on the stack
+            auto inst = gen.CreateEntryBlockAlloca(arg.getType(), std::string(this->parameters[index]->GetIdentifier().raw)); // Allocate the variable on the stack
             gen.GetBuilder().CreateStore(&arg, inst);
 
-            auto varValue = std::make_shared<CodeValue>(inst, funcVal->GetFunctionType()->GetParameters()[index]);
+            auto varValue = MakeRef<CodeValue>(inst, funcVal->GetFunctionType()->GetParameters()[index]);
 
-            gen.GetInsertPoint()->AddChild<VariableNode>(this->parameters[index++]->GetIdentifier().raw, varValue);
+            gen.GetInsertPoint()->AddChild<VariableNode>(this->parameters[index++]->GetIdentifier().id, varValue);
         }
 
         if (retType)
@@ -2000,7 +2451,7 @@ namespace Parsing
         }
 
         gen.Use(CodeGeneration::Using::NoBlock);
-        std::shared_ptr<CodeValue> funcBody = body->CodeGen(gen);
+        Ref<CodeValue> funcBody = body->CodeGen(gen);
 
         if (retType)
         {
@@ -2070,17 +2521,16 @@ namespace Parsing
                 break;
         case 30:
         {
-            std::shared_ptr<CodeType> funcReturnType;
-            std::vector<std::shared_ptr<CodeType>> funcParameters;
+            Ref<CodeType> funcReturnType;
+            std::vector<Ref<CodeType>> funcParameters;
             bool member = false;
 
-            funcReturnType = (retType == nullptr ? std::make_shared<CodeType>(llvm::Type::getVoidTy(gen.GetContext())) : gen.TypeType(*retType));
+            funcReturnType = (retType == nullptr ? gen.GetCodeType(llvm::Type::getVoidTy(gen.GetContext())) : gen.TypeType(*retType));
             std::vector<llvm::Type *> parameters;
 
             if (this->parameters.size() > 0 && this->parameters[0]->GetVariableType() == nullptr)
             {
-                auto type = std::make_shared<TemplateCodeType>(*std::static_pointer_cast<TemplateCodeType>(gen.GetCurrentType()));
-                type->type = type->type->getPointerTo();
+                auto type = gen.Retype(gen.GetCurrentType(), gen.GetCurrentType()->type->getPointerTo());
                 parameters.push_back(type->type);
                 funcParameters.push_back(type);
                 member = true;
@@ -2096,9 +2546,9 @@ namespace Parsing
             auto functionType = llvm::FunctionType::get(funcReturnType->type, parameters, false);
             auto checkFunc = llvm::Function::Create(functionType, gen.IsUsed(CodeGeneration::Using::Export) ? llvm::Function::ExternalLinkage : llvm::Function::PrivateLinkage, 0, gen.GenerateMangledName(identifier.raw), &(gen.GetModule()));
 
-            auto fValue = std::make_shared<FunctionCodeValue>(checkFunc, std::make_shared<FunctionCodeType>(funcReturnType, funcParameters, member));
+            auto fValue = MakeRef<FunctionCodeValue>(checkFunc, MakeRef<FunctionCodeType>(funcReturnType, funcParameters, member));
 
-            auto fnScope = gen.NewScope<FunctionNode>(identifier.raw, fValue);
+            auto fnScope = gen.NewScope<FunctionNode>(identifier.id, fValue);
             if (gen.IsUsed(CodeGeneration::Using::Export))
                 fnScope->Export();
 
@@ -2108,7 +2558,7 @@ namespace Parsing
         }
     }
 
-    std::shared_ptr<CodeValue> ExportDecleration::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> ExportDecleration::CodeGen(CodeGeneration &gen) const
     {
         gen.Use(CodeGeneration::Using::Export);
         auto stGen = statement->CodeGen(gen);
@@ -2116,7 +2566,7 @@ namespace Parsing
         return stGen;
     }
 
-    std::shared_ptr<CodeValue> ReturnStatement::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> ReturnStatement::CodeGen(CodeGeneration &gen) const
     {
         auto retType = static_cast<llvm::Function *>(gen.GetCurrentFunction()->value)->getFunctionType()->getReturnType();
         if (retType->getTypeID() == llvm::Type::VoidTyID && expression != nullptr)
@@ -2129,7 +2579,7 @@ namespace Parsing
         else if (expression)
         {
             auto cgen = expression->CodeGen(gen);
-            auto hretType = std::make_shared<CodeType>(retType);
+            auto hretType = gen.GetCodeType(retType);
 
             gen.SetCurrentRange(Range(expression->GetStart(), expression->GetEnd()));
             auto expr = gen.Cast(cgen, hretType);
@@ -2152,7 +2602,7 @@ namespace Parsing
         }
     }
 
-    std::shared_ptr<CodeValue> IfStatement::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> IfStatement::CodeGen(CodeGeneration &gen) const
     {
         auto currentBlock = gen.GetBuilder().GetInsertBlock();
         auto endBlock = llvm::BasicBlock::Create(gen.GetContext());
@@ -2207,7 +2657,7 @@ namespace Parsing
         return nullptr;
     }
 
-    std::shared_ptr<CodeValue> TemplateStatement::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> TemplateStatement::CodeGen(CodeGeneration &gen) const
     {
         return nullptr;
     }
@@ -2218,34 +2668,35 @@ namespace Parsing
         {
         case 0:
         {
-            if (gen.GetInsertPoint()->findSymbol(identifier.raw) != gen.GetInsertPoint()->GetChildren().end())
+            if (gen.GetInsertPoint()->findSymbol(identifier.id) != gen.GetInsertPoint()->GetChildren().end())
             {
                 ThrowCompilerError(
                     ErrorType::TemplateScope, ErrorCode::AlreadyFound,
-                    "Type or function with name " + identifier.raw + " was already found in scope!",
+                    "Type or function with name " + std::string(identifier.raw) + " was already found in scope!",
                     Range(identifier.GetStart(), identifier.GetEnd()));
                 return;
             }
             if (generic)
             {
-                gen.NewScope<TemplateNode>(identifier.raw, generic, body);
+                gen.NewScope<TemplateNode>(identifier.id, generic, body);
                 for (auto g : generic->GetParameters())
                 {
-                    gen.GetInsertPoint()->AddChild<TypeAliasNode>(g->GetIdentifier().raw);
+                    gen.GetInsertPoint()->AddChild<TypeAliasNode>(g->GetIdentifier().id);
                 }
             }
             else
             {
                 auto structType = llvm::StructType::create(gen.GetContext(), gen.GenerateMangledTypeName(identifier.raw));
-                gen.NewScope<TemplateNode>(identifier.raw, structType);
+                gen.NewScope<TemplateNode>(identifier.id, structType);
             }
 
+            gen.GetInsertPoint()->Defer(this);
             gen.LastScope();
             break;
         }
         case 10:
         {
-            auto found = gen.GetInsertPoint()->findSymbol(identifier.raw);
+            auto found = gen.GetInsertPoint()->findSymbol(identifier.id);
             if (found != gen.GetInsertPoint()->children.end())
             {
                 gen.SetInsertPoint(found->second);
@@ -2271,16 +2722,16 @@ namespace Parsing
         // auto tValue = std::make_shared<TemplateCodeValue>(structType, *fnScope);
     }
 
-    std::shared_ptr<CodeValue> TemplateInitializer::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> TemplateInitializer::CodeGen(CodeGeneration &gen) const
     {
         // auto type = gen.TypeType(this->GetTemplateType());
         auto type = gen.GetCurrentType();
-        if (const auto templ = std::dynamic_pointer_cast<TemplateCodeType>(type))
+        if (const auto templ = DynamicRefCast<TemplateCodeType>(type))
         {
             auto &node = templ->GetNode();
             auto &children = node.GetChildren();
 
-            auto values = body->GetValues();
+            const auto &values = body->GetValues();
             llvm::Value *strc = nullptr;
             if (gen.GetCurrentVar())
                 strc = gen.GetCurrentVar()->value;
@@ -2290,7 +2741,7 @@ namespace Parsing
 
             for (auto v : values)
             {
-                const auto &key = v->GetKey().raw;
+                const auto key = v->GetKey().id;
                 auto found = node.findSymbol(key);
                 if (found != children.end() && found->second->GetType() == SymbolNodeType::VariableNode)
                 {
@@ -2298,13 +2749,13 @@ namespace Parsing
                     // int index = std::find(templ->node.GetOrderedMembers().
                     int index = templ->node.IndexOf(key);
                     auto gep = gen.GetBuilder().CreateStructGEP(node.GetTemplate()->type, strc, index);
-                    auto newVal = std::make_shared<CodeValue>(gep, found->second->As<VariableNode>().GetVariable()->type);
+                    auto newVal = MakeRef<CodeValue>(gep, found->second->As<VariableNode>().GetVariable()->type);
                     gen.SetCurrentVar(newVal);
                     auto init = v->GetValue().CodeGen(gen);
                     if (init)
                     {
                         gen.SetCurrentRange(Range(v->GetStart(), v->GetEnd()));
-                        auto val = gen.Cast(init, dynamic_cast<VariableNode *>(found->second)->GetVariable()->type);
+                        auto val = gen.Cast(init, cast<VariableNode>(found->second)->GetVariable()->type);
                         gen.GetBuilder().CreateStore(val->value, gep);
                     }
                 }
@@ -2314,14 +2765,14 @@ namespace Parsing
                     str.erase(std::remove(str.begin(), str.end(), '\n'), str.end());
                     ThrowCompilerError(
                         ErrorType::TemplateInitializer, ErrorCode::CannotFind,
-                        "Cannot find variable " + key + " in type " + str + "!",
+                        "Cannot find variable " + std::string(v->GetKey().raw) + " in type " + str + "!",
                         Range(v->GetKey().GetStart(), v->GetValue().GetEnd()));
                 }
             }
             gen.SetCurrentVar(tempCurr);
             if (!gen.GetCurrentVar())
             {
-                return std::make_shared<CodeValue>(gen.GetBuilder().CreateLoad(node.GetTemplate()->type, strc), node.GetTemplate());
+                return MakeRef<CodeValue>(gen.GetBuilder().CreateLoad(node.GetTemplate()->type, strc), node.GetTemplate());
             }
             else
                 return nullptr;
@@ -2329,17 +2780,17 @@ namespace Parsing
         return nullptr;
     }
 
-    std::shared_ptr<CodeValue> ObjectInitializer::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> ObjectInitializer::CodeGen(CodeGeneration &gen) const
     {
         // if (gen.GetCurrentVar())
         // {
-        if (auto templ = std::static_pointer_cast<TemplateCodeType>(gen.GetCurrentVar()->type))
+        if (auto templ = StaticRefCast<TemplateCodeType>(gen.GetCurrentVar()->type))
         {
             auto tmpVal = gen.GetCurrentVar();
             auto &node = templ->GetNode();
             for (auto v : values)
             {
-                const auto &key = v->GetKey().raw;
+                const auto key = v->GetKey().id;
 
                 auto found = node.findSymbol(key);
                 if (found != node.children.end() && found->second->GetType() == SymbolNodeType::VariableNode)
@@ -2347,7 +2798,7 @@ namespace Parsing
                     int index = node.IndexOf(key);
                     auto gep = gen.GetBuilder().CreateStructGEP(templ->type, tmpVal->value, index);
                     // std::make_shared<CodeType>(gep->getType())
-                    auto newVal = std::make_shared<CodeValue>(gep, found->second->As<VariableNode>().GetVariable()->type);
+                    auto newVal = MakeRef<CodeValue>(gep, found->second->As<VariableNode>().GetVariable()->type);
 
                     gen.SetCurrentVar(newVal);
 
@@ -2355,7 +2806,7 @@ namespace Parsing
                     if (init)
                     {
                         gen.SetCurrentRange(Range(v->GetStart(), v->GetEnd()));
-                        auto val = gen.Cast(init, dynamic_cast<VariableNode *>(found->second)->GetVariable()->type);
+                        auto val = gen.Cast(init, cast<VariableNode>(found->second)->GetVariable()->type);
                         gen.GetBuilder().CreateStore(val->value, gep);
                     }
 
@@ -2365,7 +2816,7 @@ namespace Parsing
                 {
                     ThrowCompilerError(
                         ErrorType::TemplateInitializer, ErrorCode::CannotFind,
-                        "Cannot find variable " + key + " in type " + gen.FindSymbolInScope(&templ->GetNode()) + "!",
+                        "Cannot find variable " + std::string(v->GetKey().raw) + " in type " + gen.FindSymbolInScope(&templ->GetNode()) + "!",
                         Range(v->GetKey().GetStart(), v->GetValue().GetEnd()));
                 }
             }
@@ -2375,8 +2826,11 @@ namespace Parsing
         return nullptr;
     }
 
-    std::shared_ptr<CodeValue> ActionBaseStatement::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> ActionBaseStatement::CodeGen(CodeGeneration &gen) const
     {
+        if (!gen.IsUsed(CodeGeneration::Using::Deferred)) // Generated once its template is used, see GenerateDeferred
+            return nullptr;
+
         // auto type = gen.TypeType(*templateType);
         // TypeSyntax *t = templateType;
 
@@ -2413,7 +2867,7 @@ namespace Parsing
 
         if (type)
         {
-            auto found = gen.FindSymbolInScope(t->As<IdentifierType>().GetToken().raw);
+            auto found = gen.FindSymbolInScope(t->As<IdentifierType>().GetToken().id);
 
             if (found && found->GetType() == SymbolNodeType::TemplateNode)
             {
@@ -2442,7 +2896,7 @@ namespace Parsing
 
             if (type)
             {
-                auto &node = std::static_pointer_cast<TemplateCodeType>(type)->GetNode();
+                auto &node = StaticRefCast<TemplateCodeType>(type)->GetNode();
                 // auto found = gen.FindSymbolInScope(t->As<IdentifierType>().GetToken().raw);
 
                 // if (found && found->GetType() == SymbolNodeType::TemplateNode)
@@ -2463,8 +2917,10 @@ namespace Parsing
         }
     }
 
-    std::shared_ptr<CodeValue> ActionSpecStatement::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> ActionSpecStatement::CodeGen(CodeGeneration &gen) const
     {
+        if (!gen.IsUsed(CodeGeneration::Using::Deferred)) // Generated once its template is used, see GenerateDeferred
+            return nullptr;
 
         auto type = gen.TypeType(*templateType);
 
@@ -2473,7 +2929,7 @@ namespace Parsing
 
         if (type && specType)
         {
-            auto &node = std::static_pointer_cast<TemplateCodeType>(type)->GetNode();
+            auto &node = StaticRefCast<TemplateCodeType>(type)->GetNode();
             // auto found = gen.FindSymbolInScope(t->As<IdentifierType>().GetToken().raw);
 
             gen.SetInsertPoint(&node);
@@ -2502,8 +2958,8 @@ namespace Parsing
 
             if (type && specType)
             {
-                auto &node = std::static_pointer_cast<TemplateCodeType>(type)->GetNode();
-                auto &specNode = std::static_pointer_cast<SpecCodeType>(specType)->GetNode();
+                auto &node = StaticRefCast<TemplateCodeType>(type)->GetNode();
+                auto &specNode = StaticRefCast<SpecCodeType>(specType)->GetNode();
                 node.Implement(specNode);
 
                 gen.SetInsertPoint(&node);
@@ -2511,7 +2967,7 @@ namespace Parsing
                 gen.SetCurrentType(node.GetTemplate());
 
                 gen.Use(CodeGeneration::Using::NoBlock);
-                std::unordered_map<std::string, bool> symbols;
+                std::unordered_map<InternId, bool> symbols;
                 for (auto c : specNode.children)
                 {
                     symbols[c.first] = false;
@@ -2524,24 +2980,30 @@ namespace Parsing
                     case SyntaxType::FunctionDeclerationStatement:
                     {
                         auto &func = stmt->As<FunctionDeclerationStatement>();
-                        auto found = specNode.findSymbol(func.GetIdentifier().raw);
-                        symbols[func.GetIdentifier().raw] = true;
+                        auto found = specNode.findSymbol(func.GetIdentifier().id);
+                        symbols[func.GetIdentifier().id] = true;
 
                         if (found != specNode.children.end() && found->second->GetType() != SymbolNodeType::FunctionNode)
                         {
                             ThrowCompilerError(
                                 ErrorType::ActionSpecStatement, ErrorCode::NonFunction,
-                                "Symbol " + func.GetIdentifier().raw + " is not a function in spec " + gen.FindSymbolInScope(&specNode) + "!",
+                                "Symbol " + std::string(func.GetIdentifier().raw) + " is not a function in spec " + gen.FindSymbolInScope(&specNode) + "!",
                                 Range(func.GetStart(), func.GetEnd()));
                         }
                         else if (found != specNode.children.end())
                         {
-                            std::dynamic_pointer_cast<TemplateCodeType>(type)->GetNode().GetBody()->As<BlockStatement<>>().GetStatements().push_back(&func);
+                            // Every partition resolves this, only the first one through adds the function
+                            if (auto templBody = DynamicRefCast<TemplateCodeType>(type)->GetNode().GetBody())
+                            {
+                                auto &statements = templBody->As<BlockStatement<>>().GetStatements();
+                                if (std::find(statements.begin(), statements.end(), &func) == statements.end())
+                                    statements.push_back(&func);
+                            }
                             auto &foundFunc = found->second->As<FunctionNode>();
 
-                            auto retType = (func.GetRetType() == nullptr ? std::make_shared<CodeType>(llvm::Type::getVoidTy(gen.GetContext())) : gen.TypeType(*func.GetRetType()));
+                            auto retType = (func.GetRetType() == nullptr ? gen.GetCodeType(llvm::Type::getVoidTy(gen.GetContext())) : gen.TypeType(*func.GetRetType()));
                             bool member = false;
-                            std::vector<std::shared_ptr<CodeType>> funcParameters;
+                            std::vector<Ref<CodeType>> funcParameters;
 
                             if (func.GetParameters().size() > 0 && func.GetParameters()[0]->GetVariableType() == nullptr)
                             {
@@ -2606,7 +3068,7 @@ namespace Parsing
                                     }
                                 }
                             }
-                            auto ret = std::dynamic_pointer_cast<FunctionCodeType>(foundFunc.GetFunction()->type)->GetReturnType();
+                            auto ret = DynamicRefCast<FunctionCodeType>(foundFunc.GetFunction()->type)->GetReturnType();
                             if (*gen.TypeType(*func.GetRetType()) != *ret)
                             {
                                 ThrowCompilerError(
@@ -2620,7 +3082,7 @@ namespace Parsing
                         {
                             ThrowCompilerError(
                                 ErrorType::ActionSpecStatement, ErrorCode::CannotFind,
-                                "Function " + func.GetIdentifier().raw + " does not exist in spec!",
+                                "Function " + std::string(func.GetIdentifier().raw) + " does not exist in spec!",
                                 Range(func.GetIdentifier().GetStart(), func.GetIdentifier().GetEnd()));
                         }
 
@@ -2643,14 +3105,14 @@ namespace Parsing
                             {
                                 ThrowCompilerError(
                                     ErrorType::ActionSpecStatement, ErrorCode::CannotFind,
-                                    "Function " + f.first + " not implemented in action!",
+                                    "Function " + std::string(Interner::Get(f.first)) + " not implemented in action!",
                                     Range(keyword.position.start, this->specType->GetEnd()));
                             }
                             else if (found->second->GetType() == SymbolNodeType::TypeAliasNode)
                             {
                                 ThrowCompilerError(
                                     ErrorType::ActionSpecStatement, ErrorCode::CannotFind,
-                                    "Type alias " + f.first + " not implemented in action!",
+                                    "Type alias " + std::string(Interner::Get(f.first)) + " not implemented in action!",
                                     Range(keyword.position.start, this->specType->GetEnd()));
                             }
                         }
@@ -2667,7 +3129,7 @@ namespace Parsing
         }
     }
 
-    std::shared_ptr<CodeValue> LoopStatement::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> LoopStatement::CodeGen(CodeGeneration &gen) const
     {
         if (expression)
         {
@@ -2702,7 +3164,7 @@ namespace Parsing
         return nullptr;
     }
 
-    std::shared_ptr<CodeValue> SpecStatement::CodeGen(CodeGeneration &gen) const
+    Ref<CodeValue> SpecStatement::CodeGen(CodeGeneration &gen) const
     {
         return nullptr;
     }
@@ -2718,14 +3180,15 @@ namespace Parsing
         {
         case 0:
         {
-            auto scope = gen.NewScope<SpecNode>(identifier.raw);
+            auto scope = gen.NewScope<SpecNode>(identifier.id);
+            scope->Defer(this);
             gen.LastScope();
             break;
         }
         case 20:
         {
             // auto scope = gen.NewScope<SpecNode>(identifier.raw);
-            auto found = gen.GetInsertPoint()->findSymbol(identifier.raw);
+            auto found = gen.GetInsertPoint()->findSymbol(identifier.id);
 
             if (found != gen.GetInsertPoint()->children.end())
             {
@@ -2733,9 +3196,9 @@ namespace Parsing
                 for (auto &stmt : body->GetStatements())
                 {
                     auto &func = stmt->As<FunctionDeclerationStatement>();
-                    auto retType = (func.GetRetType() == nullptr ? std::make_shared<CodeType>(llvm::Type::getVoidTy(gen.GetContext())) : gen.TypeType(*func.GetRetType()));
+                    auto retType = (func.GetRetType() == nullptr ? gen.GetCodeType(llvm::Type::getVoidTy(gen.GetContext())) : gen.TypeType(*func.GetRetType()));
                     bool member = false;
-                    std::vector<std::shared_ptr<CodeType>> funcParameters;
+                    std::vector<Ref<CodeType>> funcParameters;
 
                     if (func.GetParameters().size() > 0 && func.GetParameters()[0]->GetVariableType() == nullptr)
                     {
@@ -2753,10 +3216,10 @@ namespace Parsing
                         }
 
                     gen.GetInsertPoint()->AddChild<FunctionNode>(
-                        func.GetIdentifier().raw,
-                        std::make_shared<FunctionCodeValue>(
+                        func.GetIdentifier().id,
+                        MakeRef<FunctionCodeValue>(
                             nullptr,
-                            std::make_shared<FunctionCodeType>(retType, funcParameters, member)));
+                            MakeRef<FunctionCodeType>(retType, funcParameters, member)));
                 }
                 gen.LastScope();
             }
@@ -2771,22 +3234,22 @@ namespace Parsing
         switch (gen.GetPreCodeGenPass())
         {
         case 0:
-            static TypeAliasNode *node = nullptr;
             if (generic)
             {
-                node = gen.GetInsertPoint()->AddChild<TypeAliasNode>(identifier.raw, generic, type);
+                auto node = gen.GetInsertPoint()->AddChild<TypeAliasNode>(identifier.id, generic, type);
                 for (auto g : generic->GetParameters())
                 {
-                    node->AddChild<TypeAliasNode>(g->GetIdentifier().raw);
+                    node->AddChild<TypeAliasNode>(g->GetIdentifier().id);
                 }
             }
             else
-                node = gen.GetInsertPoint()->AddChild<TypeAliasNode>(identifier.raw);
+                gen.GetInsertPoint()->AddChild<TypeAliasNode>(identifier.id)->Defer(this);
             break;
         case 1:
         {
-
-            if (!generic)
+            auto found = gen.GetInsertPoint()->findSymbol(identifier.id);
+            auto node = found != gen.GetInsertPoint()->children.end() ? dyn_cast<TypeAliasNode>(found->second) : nullptr;
+            if (!generic && node)
             {
                 auto lastPoint = gen.GetInsertPoint();
                 gen.SetInsertPoint(node);
@@ -2840,7 +3303,7 @@ void PrintSymbols(const SymbolNode &node, const std::string &name, int index, co
     int i = 0;
     for (auto &c : children)
     {
-        PrintSymbols(*c.second, c.first, index + 1, nindent, i == children.size() - 1);
+        PrintSymbols(*c.second, std::string(Interner::Get(c.first)), index + 1, nindent, i == children.size() - 1);
         i++;
     }
 }
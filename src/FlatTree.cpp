@@ -0,0 +1,23 @@
+#include <FlatTree.hpp>
+
+namespace Parsing
+{
+    FlatTree::FlatTree(const SyntaxNode &root)
+    {
+        nodes.push_back(&root);
+
+        // Nodes are appended as their parent is visited, so the queue is the node table itself
+        for (Index i = 0; i < nodes.size(); i++)
+        {
+            const auto &node = *nodes[i];
+            auto count = node.NumChildren();
+
+            kinds.push_back(node.GetType());
+            firstChild.push_back(static_cast<Index>(nodes.size()));
+            childCount.push_back(count);
+
+            for (int c = 0; c < count; c++)
+                nodes.push_back(&node[c]);
+        }
+    }
+} // namespace Parsing
@@ -0,0 +1,44 @@
+#include <Interner.hpp>
+
+#include <cassert>
+
+// The empty string takes id 0 so an unset id never aliases a real name
+Interner::Interner()
+{
+    ids.emplace(strings.emplace_back(), InvalidInternId);
+}
+
+Interner &Interner::Instance()
+{
+    static Interner interner;
+    return interner;
+}
+
+InternId Interner::Intern(std::string_view str)
+{
+    auto &interner = Instance();
+    {
+        std::shared_lock lock(interner.mutex);
+        auto found = interner.ids.find(str);
+        if (found != interner.ids.end())
+            return found->second;
+    }
+
+    std::unique_lock lock(interner.mutex);
+    auto found = interner.ids.find(str); // Another thread may have added it since the lookup
+    if (found != interner.ids.end())
+        return found->second;
+
+    auto id = static_cast<InternId>(interner.strings.size());
+    interner.ids.emplace(interner.strings.emplace_back(str), id);
+    return id;
+}
+
+std::string_view Interner::Get(InternId id)
+{
+    assert(id != InvalidInternId && "Interner::Get used on an unset id");
+
+    auto &interner = Instance();
+    std::shared_lock lock(interner.mutex);
+    return interner.strings[id];
+}
@@ -1,6 +1,21 @@
 #include <ModuleUnit.hpp>
+#include <Tiering.hpp>
 
-ErrorList ModuleUnit::errors;
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/TargetProcess/TargetExecutionUtils.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include <exception>
+#include <thread>
+
+thread_local ErrorList ModuleUnit::errors;
 FileIterator *ModuleUnit::globalFptr = nullptr;
 
 ModuleUnit::ModuleUnit(const std::string &filename, const std::string &moduleName) : filename{filename},
@@ -31,7 +46,7 @@ void ModuleUnit::Compile()
     if (tokenizer->IsDirty())
         return;
 
-    parser = std::make_unique<Parser>(tokenList);
+    parser = std::make_unique<Parser>(tokenList, syntaxArena);
     auto syntaxTree = parser->Parse();
 
     // for (const auto &token : tokenList)
@@ -39,32 +54,30 @@ void ModuleUnit::Compile()
     //     std::cout << token << " " << &token << std::endl;
     // }
 
-    parser->PrintNode(*syntaxTree);
+    FlatTree flatTree(*syntaxTree); // Read by PreCodeGen and the partitions
+
+    // Run needs the host layout as much as native output does, and IR is generated for the host too
+    if (!(target = CodeGeneration::CreateHostTargetMachine(optimization)))
+        return;
 
     try
     {
-        generation = std::make_unique<CodeGeneration>(moduleName);
-
-        generation->SetPreCodeGenPass(0); // First pre gen pass (All types)
-        syntaxTree->PreCodeGen(*generation);
-
-        generation->SetPreCodeGenPass(1);
-        syntaxTree->PreCodeGen(*generation);
+        generation = std::make_unique<CodeGeneration>(moduleName, target.get(), 0, jobs);
 
-        generation->SetPreCodeGenPass(10); // Second pre gen pass (Template members)
-        syntaxTree->PreCodeGen(*generation);
+        generation->PreCodeGen(flatTree); // Declare types, members and functions ahead of code generation
+        if (jobs > 1)
+            generation->ResolveAll();
 
-        generation->SetPreCodeGenPass(20); // Second pre gen pass (Spec functions)
-        syntaxTree->PreCodeGen(*generation);
-
-        generation->SetPreCodeGenPass(30); // Second pre gen pass (Action functions)
-        syntaxTree->PreCodeGen(*generation);
-
-        PrintSymbols(generation->rootSymbols);
+        if (jobs > 1)
+            GeneratePartitions(*syntaxTree, flatTree);
+        else
+        {
+            GenerateBodies(*generation, *syntaxTree);
+            generation->GenerateMain(); // Generate libc main
+        }
 
-        generation->Use(CodeGeneration::Using::NoBlock);
-        auto gen = syntaxTree->CodeGen(*generation); // Generate the llvm code from the syntax tree
-        generation->GenerateMain();                  // Generate libc main
+        if (errors.size() == 0 && tierThreshold == 0) // The passes expect valid IR
+            generation->Optimize(optimization, target.get(), output == OutputKind::Bitcode);
     }
     catch (BaseException &excep)
     {
@@ -76,7 +89,7 @@ void ModuleUnit::Compile()
         if (pe->GetErrorCode() == ErrorCode::ExpectedType)
         {
             auto pet = dynamic_cast<ExpectedTypeError *>(e);
-            Logging::Error(color::bold(color::white("Unexpected token {}. Expected {}")), pet->GetFoundToken().raw.c_str(), TokenTypeString(pet->GetTokenType()));
+            Logging::Error(color::bold(color::white("Unexpected token {}. Expected {}")), pet->GetFoundToken().raw, TokenTypeString(pet->GetTokenType()));
             if (pet->IsLeaf())
                 Logging::CharacterSnippet(fptr, pet->GetFoundToken().position);
             Logging::Log("");
@@ -114,10 +127,225 @@ void ModuleUnit::Compile()
     // PrintSymbols(generation->rootSymbols);
 }
 
-void ModuleUnit::DumpIR()
+void ModuleUnit::GenerateBodies(CodeGeneration &generation, const SyntaxNode &syntaxTree)
+{
+    generation.Use(CodeGeneration::Using::NoBlock);
+    syntaxTree.CodeGen(generation); // Generate the llvm code from the syntax tree
+    generation.GenerateDeferred();  // Generate the actions of the templates that were used
+}
+
+// Splits the function bodies between jobs threads. Each generates its share into its own context and module, then
+// they are linked into this module. Partition 0 is this module's own and is generated on the calling thread
+void ModuleUnit::GeneratePartitions(const SyntaxNode &syntaxTree, const FlatTree &flatTree)
+{
+    std::vector<Partition> partitions(jobs);
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < jobs; i++)
+        workers.emplace_back(&ModuleUnit::GeneratePartition, this, std::cref(syntaxTree), std::cref(flatTree), i, std::ref(partitions[i]));
+
+    std::exception_ptr failure;
+    try
+    {
+        GenerateBodies(*generation, syntaxTree);
+        generation->GenerateMain(); // Before linking, which replaces the declarations it refers to
+    }
+    catch (...)
+    {
+        failure = std::current_exception();
+    }
+
+    for (auto &worker : workers)
+        worker.join();
+
+    for (auto &partition : partitions)
+        for (auto e : partition.errors)
+            errors.add(e);
+
+    if (failure)
+        std::rethrow_exception(failure);
+
+    auto privateGlobals = generation->ExternalizeGlobals();
+    for (unsigned i = 1; i < jobs; i++)
+    {
+        auto &bitcode = partitions[i].bitcode;
+        if (!bitcode.empty() && !generation->LinkPartition(llvm::StringRef(bitcode.data(), bitcode.size())))
+        {
+            ThrowMidCompilerError(
+                ErrorType::TopLevelScope, ErrorCode::Link,
+                "Unable to link partition " + std::to_string(i) + " of " + moduleName,
+                Range());
+        }
+    }
+    generation->InternalizeGlobals(privateGlobals);
+}
+
+// Runs on a worker thread with its own CodeGeneration, so nothing it builds is shared with the other partitions
+void ModuleUnit::GeneratePartition(const SyntaxNode &syntaxTree, const FlatTree &flatTree, unsigned index, Partition &partition)
+{
+    CodeGeneration partitionGeneration(moduleName, target.get(), index, jobs);
+    size_t declarationErrors = SIZE_MAX;
+    try
+    {
+        partitionGeneration.PreCodeGen(flatTree);
+        partitionGeneration.ResolveAll();
+        declarationErrors = errors.size();
+
+        GenerateBodies(partitionGeneration, syntaxTree);
+        partitionGeneration.ExternalizeGlobals();
+
+        llvm::raw_svector_ostream stream(partition.bitcode);
+        llvm::WriteBitcodeToFile(partitionGeneration.GetModule(), stream);
+    }
+    catch (BaseException &excep)
+    {
+        partition.bitcode.clear();
+    }
+
+    // Declarations are the same in every partition, the first one already reports their errors
+    if (declarationErrors < errors.size())
+        partition.errors.assign(errors.begin() + declarationErrors, errors.end());
+    errors.clear();
+}
+
+// Writes the compiled module in the output kind. Native output is refused if compiling reported errors
+bool ModuleUnit::Emit()
+{
+    if (!generation)
+        return false;
+
+    if (output == OutputKind::IR)
+    {
+        DumpIR(outputPath.empty() ? "out.ll" : outputPath);
+        return errors.size() == 0;
+    }
+
+    if (errors.size() > 0)
+        return false;
+
+    switch (output)
+    {
+    case OutputKind::Bitcode:
+    {
+        std::error_code error;
+        llvm::raw_fd_ostream stream(outputPath.empty() ? "out.bc" : outputPath, error);
+        if (error)
+        {
+            llvm::errs() << "Could not open file: " << error.message() << "\n";
+            return false;
+        }
+        return WriteBitcode(stream);
+    }
+    case OutputKind::Assembly:
+        return generation->EmitFile(*target, outputPath.empty() ? "out.s" : outputPath, llvm::CGFT_AssemblyFile);
+    case OutputKind::Object:
+        return generation->EmitFile(*target, outputPath.empty() ? "out.o" : outputPath, llvm::CGFT_ObjectFile);
+    default:
+        return Link(outputPath.empty() ? "out" : outputPath);
+    }
+}
+
+bool ModuleUnit::WriteBitcode(llvm::raw_ostream &stream)
+{
+    if (!generation || errors.size() > 0)
+        return false;
+
+    generation->WriteBitcode(stream);
+    return true;
+}
+
+// Emits a temporary object file and links it into an executable
+bool ModuleUnit::Link(const std::string &executable)
+{
+    llvm::SmallString<128> objectFile;
+    if (auto error = llvm::sys::fs::createTemporaryFile(moduleName, "o", objectFile))
+    {
+        Logging::Error("Unable to create an object file: {}", error.message());
+        return false;
+    }
+
+    bool linked = generation->EmitFile(*target, std::string(objectFile.str()), llvm::CGFT_ObjectFile) &&
+                  LinkObjects({std::string(objectFile.str())}, executable);
+
+    llvm::sys::fs::remove(objectFile);
+    return linked;
+}
+
+// Links object files with the system C compiler, which knows where the C runtime is
+bool ModuleUnit::LinkObjects(const std::vector<std::string> &objectFiles, const std::string &executable)
+{
+    auto linker = llvm::sys::findProgramByName("cc");
+    if (!linker)
+    {
+        Logging::Error("Unable to find a linker: {}", linker.getError().message());
+        return false;
+    }
+
+    std::vector<llvm::StringRef> arguments{*linker};
+    arguments.insert(arguments.end(), objectFiles.begin(), objectFiles.end());
+    arguments.push_back("-o");
+    arguments.push_back(executable);
+
+    std::string message;
+    if (llvm::sys::ExecuteAndWait(*linker, arguments, llvm::None, {}, 0, 0, &message) != 0)
+    {
+        Logging::Error("Linking {} failed {}", executable, message);
+        return false;
+    }
+    return true;
+}
+
+// Compiles the module in process with an ORC JIT and calls its main, returning the exit code. Like Emit, nothing
+// runs if compiling reported errors. With a tier threshold the module starts unoptimized, see TieredModule
+int ModuleUnit::Run()
+{
+    if (!generation || errors.size() > 0)
+        return 1;
+
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    auto jit = llvm::orc::LLJITBuilder().create();
+    if (!jit)
+    {
+        Logging::Error("Unable to create a JIT: {}", llvm::toString(jit.takeError()));
+        return 1;
+    }
+
+    // Lets the program call into libc and whatever else the compiler is linked with
+    auto process = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess((*jit)->getDataLayout().getGlobalPrefix());
+    if (!process)
+    {
+        Logging::Error("Unable to search the process for symbols: {}", llvm::toString(process.takeError()));
+        return 1;
+    }
+    (*jit)->getMainJITDylib().addGenerator(std::move(*process));
+
+    // Hot functions get the optimization level, or O2 if none was asked for
+    std::unique_ptr<TieredModule> tiers;
+    if (tierThreshold > 0)
+        tiers = std::make_unique<TieredModule>(**jit, optimization == OptimizationLevel::O0 ? OptimizationLevel::O2 : optimization, tierThreshold);
+
+    if (auto error = tiers ? tiers->Add(generation->TakeModule()) : (*jit)->addIRModule(generation->TakeModule()))
+    {
+        Logging::Error("Unable to add {} to the JIT: {}", moduleName, llvm::toString(std::move(error)));
+        return 1;
+    }
+
+    auto main = (*jit)->lookup("main");
+    if (!main)
+    {
+        Logging::Error("Unable to find main: {}", llvm::toString(main.takeError()));
+        return 1;
+    }
+
+    auto entry = llvm::jitTargetAddressToFunction<int (*)(int, char *[])>(main->getAddress());
+    return llvm::orc::runAsMain(entry, {}, llvm::StringRef(moduleName));
+}
+
+void ModuleUnit::DumpIR(const std::string &filename)
 {
     std::error_code error;
-    llvm::raw_fd_ostream outputFile("out.ll", error);
+    llvm::raw_fd_ostream outputFile(filename, error);
 
     if (error)
     {
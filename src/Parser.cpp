@@ -95,11 +95,11 @@ namespace Parsing
     //     return module;
     // }
 
-    std::unique_ptr<BlockStatement<>> Parser::Parse()
+    BlockStatement<> *Parser::Parse()
     {
         tokenIterator = tokenList.begin();
         const Token &start = *tokenIterator;
-        std::vector<Statement> statements;
+        ArenaVector<Statement> statements(arena);
         while (tokenIterator->type != TokenType::Eof)
         {
             try
@@ -122,7 +122,7 @@ namespace Parsing
             }
         }
 
-        return std::make_unique<BlockStatement<>>(start, statements, *tokenIterator);
+        return arena.New<BlockStatement<>>(start, std::move(statements), *tokenIterator);
     }
 
     Statement Parser::ParseStatement()
@@ -146,7 +146,7 @@ namespace Parsing
         default:
             auto expr = ParseExpression();
             if (expr)
-                return new ExpressionStatement(expr);
+                return arena.New<ExpressionStatement>(expr);
         }
         return nullptr;
     }
@@ -193,7 +193,7 @@ namespace Parsing
 
         const Token &open = Expect(TokenType::LeftCurly);
 
-        std::vector<Statement> statements;
+        ArenaVector<Statement> statements(arena);
         while (tokenIterator->type != TokenType::RightCurly && tokenIterator->type != TokenType::Eof)
         {
             if (tokenIterator->type == TokenType::Newline)
@@ -218,7 +218,7 @@ namespace Parsing
 
         const Token &close = Expect(TokenType::RightCurly);
 
-        return new TemplateStatement(keyword, identifier, generic, open, statements, close);
+        return arena.New<TemplateStatement>(keyword, identifier, generic, arena.New<BlockStatement<>>(open, std::move(statements), close));
     }
 
     Statement Parser::ParseTemplateScopeStatement()
@@ -251,7 +251,7 @@ namespace Parsing
 
         const Token &open = Expect(TokenType::LeftCurly);
 
-        std::vector<Statement> statements;
+        ArenaVector<Statement> statements(arena);
         while (tokenIterator->type != TokenType::RightCurly && tokenIterator->type != TokenType::Eof)
         {
             if (tokenIterator->type == TokenType::Newline)
@@ -264,7 +264,7 @@ namespace Parsing
 
         const Token &close = Expect(TokenType::RightCurly);
 
-        return new SpecStatement(keyword, identifier, generic, open, statements, close);
+        return arena.New<SpecStatement>(keyword, identifier, generic, arena.New<BlockStatement<>>(open, std::move(statements), close));
     }
 
     Statement Parser::ParseSpecScopeStatement()
@@ -295,7 +295,7 @@ namespace Parsing
     Statement Parser::ParseBlockStatement()
     {
         const Token &left = Expect(TokenType::LeftCurly);
-        std::vector<Statement> statements;
+        ArenaVector<Statement> statements(arena);
         while (tokenIterator->type != TokenType::RightCurly && tokenIterator->type != TokenType::Eof)
         {
             try
@@ -319,7 +319,7 @@ namespace Parsing
             }
         }
         const Token &right = Expect(TokenType::RightCurly);
-        return new BlockStatement(left, statements, right);
+        return arena.New<BlockStatement<>>(left, std::move(statements), right);
     }
 
     Statement Parser::ParseTemplateVariableDecleration()
@@ -352,7 +352,7 @@ namespace Parsing
             {
                 auto setArrow = Next();
                 auto set = ParseStatement();
-                eb = new ExpressionBodyStatement(getArrow, setArrow, set);
+                eb = arena.New<ExpressionBodyStatement>(getArrow, setArrow, set);
             }
             else
             {
@@ -361,21 +361,21 @@ namespace Parsing
                 {
                     auto setArrow = Next();
                     auto set = ParseStatement();
-                    eb = new ExpressionBodyStatement(getArrow, get, setArrow, set);
+                    eb = arena.New<ExpressionBodyStatement>(getArrow, get, setArrow, set);
                 }
                 else
                 {
-                    eb = new ExpressionBodyStatement(getArrow, get);
+                    eb = arena.New<ExpressionBodyStatement>(getArrow, get);
                 }
             }
-            return new VariableDeclerationStatement(let, ident, eb, type);
+            return arena.New<VariableDeclerationStatement>(let, ident, eb, type);
         }
 
         default:
             break;
         }
 
-        return new VariableDeclerationStatement(let, ident, type, nullptr);
+        return arena.New<VariableDeclerationStatement>(let, ident, type, nullptr);
     }
 
     Statement Parser::ParseActionExpressionBody()
@@ -411,7 +411,7 @@ namespace Parsing
         {
             auto setArrow = Next();
             auto set = ParseStatement();
-            eb = new ExpressionBodyStatement(getArrow, setArrow, set);
+            eb = arena.New<ExpressionBodyStatement>(getArrow, setArrow, set);
         }
         else
         {
@@ -420,14 +420,14 @@ namespace Parsing
             {
                 auto setArrow = Next();
                 auto set = ParseStatement();
-                eb = new ExpressionBodyStatement(getArrow, get, setArrow, set);
+                eb = arena.New<ExpressionBodyStatement>(getArrow, get, setArrow, set);
             }
             else
             {
-                eb = new ExpressionBodyStatement(getArrow, get);
+                eb = arena.New<ExpressionBodyStatement>(getArrow, get);
             }
         }
-        return new VariableDeclerationStatement(let, ident, eb, type);
+        return arena.New<VariableDeclerationStatement>(let, ident, eb, type);
     }
 
     Statement Parser::ParseSpecVariableDecleration()
@@ -457,24 +457,26 @@ namespace Parsing
         }
         const Token &left = Expect(TokenType::LeftCurly);
 
-        if (tokenIterator->type == TokenType::Identifier && (tokenIterator->raw == "get" || tokenIterator->raw == "set"))
+        static const auto getId = Interner::Intern("get");
+        static const auto setId = Interner::Intern("set");
+        if (tokenIterator->type == TokenType::Identifier && (tokenIterator->id == getId || tokenIterator->id == setId))
         {
-            const Token &get = tokenIterator->raw == "get" ? Next() : TokenNull;
+            const Token &get = tokenIterator->id == getId ? Next() : TokenNull;
             if (tokenIterator->type == TokenType::Identifier)
             {
-                if (tokenIterator->raw != "set")
+                if (tokenIterator->id != setId)
                     goto ERROR;
-                const Token &set = tokenIterator->raw == "set" ? Next() : TokenNull;
+                const Token &set = tokenIterator->id == setId ? Next() : TokenNull;
                 const Token &right = Expect(TokenType::RightCurly);
-                auto eb = new ExpressionBodySpecStatement(left, get, set, right);
-                return new VariableDeclerationStatement(let, ident, eb, type);
+                auto eb = arena.New<ExpressionBodySpecStatement>(left, get, set, right);
+                return arena.New<VariableDeclerationStatement>(let, ident, eb, type);
             }
             else
             {
-                const Token &set = tokenIterator->raw == "set" ? Next() : TokenNull;
+                const Token &set = tokenIterator->id == setId ? Next() : TokenNull;
                 const Token &right = Expect(TokenType::RightCurly);
-                auto eb = new ExpressionBodySpecStatement(left, get, set, right);
-                return new VariableDeclerationStatement(let, ident, eb, type);
+                auto eb = arena.New<ExpressionBodySpecStatement>(left, get, set, right);
+                return arena.New<VariableDeclerationStatement>(let, ident, eb, type);
             }
         }
     ERROR:
@@ -504,7 +506,7 @@ namespace Parsing
             const Token &equal = Next();
             initializer = ParseExpression();
         }
-        return new VariableDeclerationStatement(let, ident, type, initializer);
+        return arena.New<VariableDeclerationStatement>(let, ident, type, initializer);
     }
 
     Statement Parser::ParseConst()
@@ -546,7 +548,7 @@ namespace Parsing
         }
         initializer = ParseExpression();
 
-        return new VariableDeclerationStatement(keyword, ident, type, initializer);
+        return arena.New<VariableDeclerationStatement>(keyword, ident, type, initializer);
     }
 
     Statement Parser::ParseFunctionDecleration(const Token &keyword, const Token &ident)
@@ -557,7 +559,7 @@ namespace Parsing
 
         const Token &left = Expect(TokenType::LeftParen);
 
-        std::vector<VariableDeclerationStatement *> parameters;
+        ArenaVector<VariableDeclerationStatement *> parameters(arena);
         bool defaultInit = false;
         while (tokenIterator->type != TokenType::RightParen && tokenIterator->type != TokenType::Eof)
         {
@@ -566,7 +568,7 @@ namespace Parsing
                 Next();
                 continue;
             }
-            auto var = dynamic_cast<VariableDeclerationStatement *>(ParseVariableDecleration());
+            auto var = dyn_cast_or_null<VariableDeclerationStatement>(ParseVariableDecleration());
             if (!defaultInit && var->HasInitializer())
                 defaultInit = true;
             else if (defaultInit && !var->HasInitializer())
@@ -602,7 +604,7 @@ namespace Parsing
         //                       tokenIterator->position)
         // }
         auto body = ParseStatement();
-        return new FunctionDeclerationStatement(keyword, ident, generic, left, parameters, right, arrow, type, body);
+        return arena.New<FunctionDeclerationStatement>(keyword, ident, generic, left, std::move(parameters), right, arrow, type, body);
     }
 
     Statement Parser::ParseSpecFunctionDecleration(const Token &keyword, const Token &ident)
@@ -612,7 +614,7 @@ namespace Parsing
             generic = ParseGenericParameter();
 
         const Token &left = Next();
-        std::vector<VariableDeclerationStatement *> parameters;
+        ArenaVector<VariableDeclerationStatement *> parameters(arena);
         bool defaultInit = false;
         while (tokenIterator->type != TokenType::RightParen && tokenIterator->type != TokenType::Eof)
         {
@@ -621,7 +623,7 @@ namespace Parsing
                 Next();
                 continue;
             }
-            auto var = dynamic_cast<VariableDeclerationStatement *>(ParseVariableDecleration());
+            auto var = dyn_cast_or_null<VariableDeclerationStatement>(ParseVariableDecleration());
             if (!defaultInit && var->HasInitializer())
                 defaultInit = true;
             else if (defaultInit && !var->HasInitializer())
@@ -645,9 +647,9 @@ namespace Parsing
         {
             const Token &arrow = Expect(TokenType::FuncArrow);
             auto type = ParseType();
-            return new FunctionDeclerationStatement(keyword, ident, generic, left, parameters, right, arrow, type);
+            return arena.New<FunctionDeclerationStatement>(keyword, ident, generic, left, std::move(parameters), right, arrow, type);
         }
-        return new FunctionDeclerationStatement(keyword, ident, generic, left, parameters, right);
+        return arena.New<FunctionDeclerationStatement>(keyword, ident, generic, left, std::move(parameters), right);
     }
 
     Statement Parser::ParseIfStatement()
@@ -658,7 +660,7 @@ namespace Parsing
         UnUse(Using::If);
 
         auto body = ParseStatement();
-        ElseStatement *elseClause = dynamic_cast<ElseStatement *>(ParseElif());
+        ElseStatement *elseClause = dyn_cast_or_null<ElseStatement>(ParseElif());
         if (elseClause && tokenIterator->type == TokenType::Elif)
         {
             auto bad = ParseElif();
@@ -672,7 +674,7 @@ namespace Parsing
             {
             }
         }
-        return new IfStatement(keyword, expression, body, elseClause);
+        return arena.New<IfStatement>(keyword, expression, body, elseClause);
 
         return nullptr;
     }
@@ -686,14 +688,14 @@ namespace Parsing
             auto expression = ParseExpression();
             UnUse(Using::If);
             auto body = ParseStatement();
-            auto ifs = new IfStatement(keyword, expression, body, dynamic_cast<ElseStatement *>(ParseElif()));
-            return new ElseStatement(keyword, ifs);
+            auto ifs = arena.New<IfStatement>(keyword, expression, body, dyn_cast_or_null<ElseStatement>(ParseElif()));
+            return arena.New<ElseStatement>(keyword, ifs);
         }
         else if (tokenIterator->type == TokenType::Else)
         {
             const Token &keyword = Next();
             auto body = ParseStatement();
-            return new ElseStatement(keyword, body);
+            return arena.New<ElseStatement>(keyword, body);
         }
         return nullptr;
     }
@@ -706,7 +708,7 @@ namespace Parsing
             expression = ParseExpression();
         auto body = ParseStatement();
         if (body)
-            return new LoopStatement(keyword, expression, body);
+            return arena.New<LoopStatement>(keyword, expression, body);
         return nullptr;
     }
 
@@ -716,7 +718,7 @@ namespace Parsing
         Expression expr = nullptr;
         if (tokenIterator->type != TokenType::Newline)
             expr = ParseExpression();
-        return new ReturnStatement(keyword, expr);
+        return arena.New<ReturnStatement>(keyword, expr);
     }
 
     Statement Parser::ParseYieldStatement()
@@ -724,7 +726,7 @@ namespace Parsing
         const Token &keyword = Expect(TokenType::Yield);
         auto expression = ParseExpression();
         if (expression)
-            return new YieldStatement(keyword, expression);
+            return arena.New<YieldStatement>(keyword, expression);
         return nullptr;
     }
 
@@ -741,9 +743,9 @@ namespace Parsing
                 auto typeB = ParseType();
                 if (typeB)
                 {
-                    auto body = dynamic_cast<BlockStatement<> *>(ParseActionBody());
+                    auto body = dyn_cast_or_null<BlockStatement<>>(ParseActionBody());
                     if (body)
-                        return new ActionSpecStatement(keyword, typeB, in, typeA, body);
+                        return arena.New<ActionSpecStatement>(keyword, typeB, in, typeA, body);
                     else
                         return nullptr;
                 }
@@ -759,9 +761,9 @@ namespace Parsing
             }
             else
             {
-                auto body = dynamic_cast<BlockStatement<> *>(ParseActionBody());
+                auto body = dyn_cast_or_null<BlockStatement<>>(ParseActionBody());
                 if (body)
-                    return new ActionBaseStatement(keyword, typeA, body);
+                    return arena.New<ActionBaseStatement>(keyword, typeA, body);
                 else
                     return nullptr;
             }
@@ -781,7 +783,7 @@ namespace Parsing
     {
         const Token &left = Next();
 
-        std::vector<Statement> statements;
+        ArenaVector<Statement> statements(arena);
         while (tokenIterator->type != TokenType::RightCurly && tokenIterator->type != TokenType::Eof)
         {
             try
@@ -807,7 +809,7 @@ namespace Parsing
         const Token &right = Expect(TokenType::RightCurly);
         if (right == TokenNull)
             return nullptr;
-        return new BlockStatement(left, statements, right);
+        return arena.New<BlockStatement<>>(left, std::move(statements), right);
     }
 
     Statement Parser::ParseActionScopeStatement()
@@ -864,7 +866,7 @@ namespace Parsing
         const Token &ident = Expect(TokenType::Identifier);
         const Token &left = Expect(TokenType::LeftCurly);
 
-        std::vector<EnumIdentifierStatement *> statements;
+        ArenaVector<EnumIdentifierStatement *> statements(arena);
         while (tokenIterator->type != TokenType::RightCurly && tokenIterator->type != TokenType::Eof)
         {
             if (tokenIterator->type == TokenType::Newline)
@@ -872,7 +874,7 @@ namespace Parsing
                 Next();
                 continue;
             }
-            statements.push_back(new EnumIdentifierStatement(Expect(TokenType::Identifier)));
+            statements.push_back(arena.New<EnumIdentifierStatement>(Expect(TokenType::Identifier)));
             if (tokenIterator->type != TokenType::RightCurly)
                 Expect(TokenType::Comma);
             else if (tokenIterator->type == TokenType::Comma)
@@ -880,7 +882,7 @@ namespace Parsing
         }
 
         const Token &right = Expect(TokenType::RightCurly);
-        return new EnumStatement(keyword, ident, left, statements, right);
+        return arena.New<EnumStatement>(keyword, ident, arena.New<BlockStatement<EnumIdentifierStatement>>(left, std::move(statements), right));
     }
 
     Statement Parser::ParseTypeAlias()
@@ -894,7 +896,7 @@ namespace Parsing
 
         const Token &eq = Expect(TokenType::Equal);
         TypeSyntax *type = ParseType();
-        return new TypeAliasStatement(keyword, identifier, generic, eq, type);
+        return arena.New<TypeAliasStatement>(keyword, identifier, generic, eq, type);
     }
 
     Statement Parser::ParseSpecTypeAlias()
@@ -906,20 +908,20 @@ namespace Parsing
         if (tokenIterator->type == TokenType::LeftAngle)
             generic = ParseGenericParameter();
 
-        return new TypeAliasStatement(keyword, identifier, generic);
+        return arena.New<TypeAliasStatement>(keyword, identifier, generic);
     }
 
     Statement Parser::ParseExport()
     {
         const Token &keyword = Expect(TokenType::Export);
         Statement st = ParseTopLevelScopeStatement();
-        return new ExportDecleration(keyword, st);
+        return arena.New<ExportDecleration>(keyword, st);
     }
 
     GenericParameter *Parser::ParseGenericParameter()
     {
         const Token &left = Expect(TokenType::LeftAngle);
-        std::vector<GenericParameterEntry *> parameters;
+        ArenaVector<GenericParameterEntry *> parameters(arena);
         while (tokenIterator->type != TokenType::RightAngle && tokenIterator->type != TokenType::Eof)
         {
             try
@@ -944,13 +946,13 @@ namespace Parsing
             }
         }
         const Token &right = Expect(TokenType::RightAngle);
-        return new GenericParameter(left, parameters, right);
+        return arena.New<GenericParameter>(left, std::move(parameters), right);
     }
 
     GenericParameterEntry *Parser::ParseGenericParameterEntry()
     {
         const Token &identifier = Expect(TokenType::Identifier);
-        std::vector<TypeSyntax *> constraints;
+        ArenaVector<TypeSyntax *> constraints(arena);
         if (tokenIterator->type == TokenType::Colon)
         {
             const Token &colon = Next();
@@ -968,13 +970,13 @@ namespace Parsing
                     ThrowExpectedType(ErrorType::Expect, "Expected comma or right angle", TokenType::Comma);
             }
         }
-        return new GenericParameterEntry(identifier, constraints);
+        return arena.New<GenericParameterEntry>(identifier, std::move(constraints));
     }
 
     ObjectInitializer *Parser::ParseObjectInitializer()
     {
         auto &left = Expect(TokenType::LeftCurly);
-        std::vector<ObjectKeyValue *> values;
+        ArenaVector<ObjectKeyValue *> values(arena);
         while (tokenIterator->type != TokenType::RightCurly && tokenIterator->type != TokenType::Comma && tokenIterator->type != TokenType::Eof)
         {
             try
@@ -987,7 +989,7 @@ namespace Parsing
                 const Token &key = Expect(TokenType::Identifier);
                 const Token &colon = Expect(TokenType::Colon);
                 auto value = ParseExpression();
-                values.push_back(new ObjectKeyValue(key, colon, value));
+                values.push_back(arena.New<ObjectKeyValue>(key, colon, value));
                 if (tokenIterator->type != TokenType::RightCurly && tokenIterator->type != TokenType::Newline)
                     Expect(TokenType::Comma);
                 else if (tokenIterator->type == TokenType::Comma)
@@ -1006,7 +1008,7 @@ namespace Parsing
             }
         }
         auto &right = Expect(TokenType::RightCurly);
-        return new ObjectInitializer(left, values, right);
+        return arena.New<ObjectInitializer>(left, std::move(values), right);
     }
 
     MatchEntry *Parser::ParseMatchEntry()
@@ -1019,7 +1021,7 @@ namespace Parsing
         const Token &arrow = Expect(TokenType::FuncArrow);
         auto stmt = ParseStatement();
 
-        return new MatchEntry(expr, arrow, stmt);
+        return arena.New<MatchEntry>(expr, arrow, stmt);
     }
 
     Expression Parser::ParseExpression(uint8_t parentPrecedence, Expression left)
@@ -1032,7 +1034,7 @@ namespace Parsing
                 const Token &op = Next();
                 auto right = ParseExpression(unaryPrecedence);
                 if (right)
-                    left = new UnaryExpression(right, op);
+                    left = arena.New<UnaryExpression>(right, op);
             }
             else
             {
@@ -1044,7 +1046,7 @@ namespace Parsing
         {
             ThrowCompilerError(
                 ErrorType::Expression, ErrorCode::NoLeft,
-                std::string("Unexpected token `") + tokenIterator->raw + ("` in expression!"),
+                std::string("Unexpected token `") + std::string(tokenIterator->raw) + ("` in expression!"),
                 tokenIterator->position);
             // // Logging::Error(color::bold(color::white("Unexpected token `{}` in expression!")), tokenIterator->raw.c_str());
             // // Logging::CharacterSnippet(fptr, tokenIterator->position);
@@ -1060,7 +1062,7 @@ namespace Parsing
                 auto right = ParseType();
                 if (right)
                 {
-                    left = new CastExpression(left, op, right);
+                    left = arena.New<CastExpression>(left, op, right);
                     continue;
                 }
                 else
@@ -1081,7 +1083,7 @@ namespace Parsing
                     right = ParseExpression(parentPrecedence + 1, right);
                 }
 
-                left = new BinaryExpression(left, right, op);
+                left = arena.New<BinaryExpression>(left, right, op);
             }
             catch (const BaseException &e)
             {
@@ -1105,7 +1107,7 @@ namespace Parsing
 
             default:
                 const Token &op = Next();
-                left = new PostfixExpression(left, op);
+                left = arena.New<PostfixExpression>(left, op);
                 return ParseExpression(0, left);
                 break;
             }
@@ -1141,18 +1143,18 @@ namespace Parsing
         case TokenType::Integer:
         {
             const Token &token = Next();
-            return new IntegerSyntax(token);
+            return arena.New<IntegerSyntax>(token);
         }
         case TokenType::Floating:
         {
             const Token &token = Next();
-            return new FloatingSyntax(token);
+            return arena.New<FloatingSyntax>(token);
         }
         case TokenType::True:
         case TokenType::False:
         {
             const Token &token = Next();
-            return new BooleanSyntax(token);
+            return arena.New<BooleanSyntax>(token);
         }
         // case TokenType::Char:
         // {
@@ -1162,7 +1164,7 @@ namespace Parsing
         case TokenType::String:
         {
             const Token &token = Next();
-            return new StringSyntax(token);
+            return arena.New<StringSyntax>(token);
         }
         case TokenType::Identifier:
         {
@@ -1183,7 +1185,7 @@ namespace Parsing
         default:
             ThrowCompilerError(
                 ErrorType::Literal, ErrorCode::UnknownLiteral,
-                std::string("Expected a literal value! Found token `") + tokenIterator->raw + std::string("` instead."),
+                std::string("Expected a literal value! Found token `") + std::string(tokenIterator->raw) + std::string("` instead."),
                 tokenIterator->position);
             // auto type = ParseType();
             // if (type)
@@ -1207,14 +1209,14 @@ namespace Parsing
         switch (tokenIterator->type)
         {
         default:
-            return new IdentifierExpression(token);
+            return arena.New<IdentifierExpression>(token);
         }
     }
 
     Expression Parser::ParseFunctionCall(Expression fn)
     {
         const Token &left = Expect(TokenType::LeftParen);
-        std::vector<Parsing::Expression> args;
+        ArenaVector<Parsing::Expression> args(arena);
 
         while (tokenIterator->type != TokenType::RightParen && tokenIterator->type != TokenType::Eof)
         {
@@ -1239,14 +1241,14 @@ namespace Parsing
         }
 
         const Token &right = Expect(TokenType::RightParen);
-        return new CallExpression(fn, left, right, args);
+        return arena.New<CallExpression>(fn, left, right, std::move(args));
     }
 
     Expression Parser::ParseAnonymousFunction()
     {
         const Token &left = Expect(TokenType::LeftParen);
 
-        std::vector<VariableDeclerationStatement *> parameters;
+        ArenaVector<VariableDeclerationStatement *> parameters(arena);
         bool defaultInit = false;
         while (tokenIterator->type != TokenType::RightParen && tokenIterator->type != TokenType::Eof)
         {
@@ -1255,7 +1257,7 @@ namespace Parsing
                 Next();
                 continue;
             }
-            auto var = dynamic_cast<VariableDeclerationStatement *>(ParseVariableDecleration());
+            auto var = dyn_cast_or_null<VariableDeclerationStatement>(ParseVariableDecleration());
             if (!defaultInit && var->HasInitializer())
                 defaultInit = true;
             else if (defaultInit && !var->HasInitializer())
@@ -1279,7 +1281,7 @@ namespace Parsing
         const Token &arrow = Expect(TokenType::FuncArrow);
         auto type = ParseType();
         auto body = ParseStatement();
-        return new AnonymousFunctionExpression(left, parameters, right, arrow, type, body);
+        return arena.New<AnonymousFunctionExpression>(left, std::move(parameters), right, arrow, type, body);
     }
 
     Expression Parser::ParseSubscript(Expression expr)
@@ -1287,7 +1289,7 @@ namespace Parsing
         const Token &left = Expect(TokenType::LeftSquare);
         auto subsr = ParseExpression();
         const Token &right = Expect(TokenType::RightSquare);
-        return new SubscriptExpression(expr, left, subsr, right);
+        return arena.New<SubscriptExpression>(expr, left, subsr, right);
     }
 
     Expression Parser::ParseTemplateInitializer(TypeSyntax *type)
@@ -1295,7 +1297,7 @@ namespace Parsing
         auto initializer = ParseObjectInitializer();
         if (initializer->GetValues().empty())
             initializer = nullptr;
-        return new TemplateInitializer(type, initializer);
+        return arena.New<TemplateInitializer>(type, initializer);
     }
 
     ArrayLiteralEntry *Parser::ParseArrayLiteralEntry()
@@ -1305,15 +1307,15 @@ namespace Parsing
         {
             const Token &colon = Next();
             auto boundary = ParseExpression();
-            return new ArrayLiteralBoundaryEntry(expression, colon, boundary);
+            return arena.New<ArrayLiteralBoundaryEntry>(expression, colon, boundary);
         }
-        return new ArrayLiteralExpressionEntry(expression);
+        return arena.New<ArrayLiteralExpressionEntry>(expression);
     }
 
     Expression Parser::ParseArrayLiteral()
     {
         const Token &left = Expect(TokenType::LeftSquare);
-        std::vector<ArrayLiteralEntry *> values;
+        ArenaVector<ArrayLiteralEntry *> values(arena);
         while (tokenIterator->type != TokenType::RightSquare && tokenIterator->type != TokenType::Eof)
         {
             try
@@ -1331,7 +1333,7 @@ namespace Parsing
             }
         }
         const Token &right = Expect(TokenType::RightSquare);
-        return new ArrayLiteral(left, values, right);
+        return arena.New<ArrayLiteral>(left, std::move(values), right);
     }
 
     Expression Parser::ParseMatch()
@@ -1340,7 +1342,7 @@ namespace Parsing
         auto expr = ParseExpression();
         const Token &left = Expect(TokenType::LeftCurly);
 
-        std::vector<MatchEntry *> entries;
+        ArenaVector<MatchEntry *> entries(arena);
         while (tokenIterator->type != TokenType::RightCurly && tokenIterator->type != TokenType::Eof)
         {
             try
@@ -1361,7 +1363,7 @@ namespace Parsing
         }
         const Token &right = Expect(TokenType::RightCurly);
 
-        return new MatchExpression(keyword, expr, new BlockStatement(left, entries, right));
+        return arena.New<MatchExpression>(keyword, expr, arena.New<BlockStatement<MatchEntry>>(left, std::move(entries), right));
     }
 
     TypeSyntax *Parser::ParseType()
@@ -1370,19 +1372,19 @@ namespace Parsing
         switch (tokenIterator->type)
         {
         case TokenType::Identifier:
-            baseType = new IdentifierType(Next());
+            baseType = arena.New<IdentifierType>(Next());
             break;
         case TokenType::Int:
         case TokenType::Uint:
         case TokenType::Bool:
         case TokenType::Float:
         case TokenType::Char:
-            baseType = new PrimitiveType(Next());
+            baseType = arena.New<PrimitiveType>(Next());
             break;
         case TokenType::LeftParen:
         {
             const Token &left = Next();
-            std::vector<TypeSyntax *> parameters;
+            ArenaVector<TypeSyntax *> parameters(arena);
 
             while (tokenIterator->type != TokenType::RightParen && tokenIterator->type != TokenType::Eof)
             {
@@ -1408,7 +1410,7 @@ namespace Parsing
             const Token &right = Expect(TokenType::RightParen);
 
             auto retType = ParseType();
-            baseType = new FunctionType(left, parameters, right, tokenIterator->type == TokenType::FuncArrow ? Next() : TokenNull, retType);
+            baseType = arena.New<FunctionType>(left, std::move(parameters), right, tokenIterator->type == TokenType::FuncArrow ? Next() : TokenNull, retType);
             break;
         }
         case TokenType::Ampersand:
@@ -1416,7 +1418,7 @@ namespace Parsing
             const Token &amp = Next();
             baseType = ParseType();
             if (baseType)
-                baseType = new ReferenceType(amp, baseType);
+                baseType = arena.New<ReferenceType>(amp, baseType);
             break;
         }
         case TokenType::LeftSquare:
@@ -1428,11 +1430,11 @@ namespace Parsing
                 const Token &colon = Next();
                 auto size = ParseExpression();
                 const Token &close = Expect(TokenType::RightSquare);
-                baseType = new ArrayType(open, type, colon, size, close);
+                baseType = arena.New<ArrayType>(open, type, colon, size, close);
                 break;
             }
             const Token &close = Expect(TokenType::RightSquare);
-            baseType = new ArrayType(open, type, close);
+            baseType = arena.New<ArrayType>(open, type, close);
             break;
         }
         default:
@@ -1441,7 +1443,7 @@ namespace Parsing
         if (tokenIterator->type == TokenType::LeftAngle)
         {
             const Token &left = Next();
-            std::vector<TypeSyntax *> arguments;
+            ArenaVector<TypeSyntax *> arguments(arena);
 
             while (tokenIterator->type != TokenType::RightAngle && tokenIterator->type != TokenType::Eof)
             {
@@ -1467,7 +1469,7 @@ namespace Parsing
             const Token &right = Expect(TokenType::RightAngle);
             if (right == TokenNull)
                 return nullptr;
-            baseType = new GenericType(baseType, left, arguments, right);
+            baseType = arena.New<GenericType>(baseType, left, std::move(arguments), right);
         }
         return baseType;
     }
@@ -1613,7 +1615,7 @@ namespace Parsing
         }
     }
 
-    void Parser::PrintNode(const SyntaxNode &node, int index, const std::wstring &indent, bool last)
+    void Parser::PrintNode(const FlatTree &tree, FlatTree::Index node, int index, const std::wstring &indent, bool last)
     {
 #ifdef PLATFORM_WINDOWS
         _setmode(_fileno(stdout), _O_U16TEXT);
@@ -1635,23 +1637,23 @@ namespace Parsing
         _setmode(_fileno(stdout), _O_TEXT);
 #endif
 
-        std::cout << node << std::endl;
+        std::cout << tree.Node(node) << std::endl;
 
         std::wstring nindent = indent + (index == 0 ? L"" : (last ? L"    " : L"│   "));
-        auto len = node.NumChildren();
+        auto len = tree.NumChildren(node);
         for (int i = 0; i < len; i++)
         {
-            PrintNode(node[i], index + 1, nindent, i == node.NumChildren() - 1);
+            PrintNode(tree, tree.Child(node, i), index + 1, nindent, i == len - 1);
         }
     }
 
-    void Parser::RecurseNode(const SyntaxNode &node)
+    void Parser::RecurseNode(const FlatTree &tree, FlatTree::Index node)
     {
-        std::cout << node << std::endl;
+        std::cout << tree.Node(node) << std::endl;
 
-        for (int i = 0; i < node.NumChildren(); i++)
+        for (int i = 0; i < tree.NumChildren(node); i++)
         {
-            RecurseNode(node[i]);
+            RecurseNode(tree, tree.Child(node, i));
         }
     }
 } // namespace Parsing
@@ -1693,6 +1695,8 @@ std::ostream &operator<<(std::ostream &stream, const Parsing::SyntaxType &e)
         ets(TemplateStatement);
         ets(SpecStatement);
         ets(BlockStatement);
+        ets(EnumBlockStatement);
+        ets(MatchBlockStatement);
         ets(ExpressionStatement);
         ets(VariableDeclerationStatement);
         ets(FunctionDeclerationStatement);
@@ -0,0 +1,127 @@
+#include <ThinLink.hpp>
+#include <ModuleUnit.hpp>
+#include <Log.hpp>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/raw_ostream.h>
+
+// Runs the backends on jobs threads, or one per core if it is 0
+ThinLink::ThinLink(OptimizationLevel level, unsigned jobs)
+{
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    llvm::InitializeNativeTargetAsmParser();
+
+    llvm::lto::Config config;
+    config.CPU = llvm::sys::getHostCPUName().str();
+    config.MAttrs = CodeGeneration::HostFeatures();
+    config.RelocModel = llvm::Reloc::PIC_;
+    config.DefaultTriple = llvm::sys::getDefaultTargetTriple();
+    config.CGOptLevel = CodeGeneration::CodeGenLevel(level);
+    switch (level)
+    {
+    case OptimizationLevel::O0:
+        config.OptLevel = 0;
+        break;
+    case OptimizationLevel::O1:
+        config.OptLevel = 1;
+        break;
+    case OptimizationLevel::O3:
+        config.OptLevel = 3;
+        break;
+    default:
+        config.OptLevel = 2;
+        break;
+    }
+
+    auto threads = jobs > 0 ? llvm::heavyweight_hardware_concurrency(jobs) : llvm::heavyweight_hardware_concurrency();
+    lto = std::make_unique<llvm::lto::LTO>(std::move(config), llvm::lto::createInProcessThinBackend(threads));
+}
+
+// Adds a module written by ModuleUnit::WriteBitcode. The name identifies it in the link and has to be unique
+bool ThinLink::Add(const std::string &name, llvm::SmallVector<char, 0> bitcode)
+{
+    auto &buffer = bitcodes.emplace_back(std::move(bitcode));
+    auto input = llvm::lto::InputFile::create(llvm::MemoryBufferRef(llvm::StringRef(buffer.data(), buffer.size()), name));
+    if (!input)
+    {
+        Logging::Error("Unable to read the bitcode of {}: {}", name, llvm::toString(input.takeError()));
+        return false;
+    }
+
+    auto symbols = (*input)->symbols();
+    std::vector<llvm::lto::SymbolResolution> resolutions(symbols.size());
+    for (size_t i = 0; i < symbols.size(); i++)
+    {
+        if (symbols[i].isUndefined())
+            continue;
+
+        // Two modules with the same file name mangle to the same symbols, so they end up here too
+        if (!symbols[i].isWeak())
+        {
+            auto [owner, inserted] = strongDefinitions.try_emplace(symbols[i].getName(), name);
+            if (!inserted)
+            {
+                Logging::Error("{} is defined in both {} and {}", symbols[i].getIRName().str(), owner->second, name);
+                return false;
+            }
+        }
+
+        resolutions[i].Prevailing = defined.insert(symbols[i].getName()).second;
+        resolutions[i].FinalDefinitionInLinkageUnit = true;
+        // getName is mangled for the target, _main on some. Everything else can be internalized
+        resolutions[i].VisibleToRegularObj = symbols[i].getIRName() == "main";
+    }
+
+    if (auto error = lto->add(std::move(*input), resolutions))
+    {
+        Logging::Error("Unable to add {} to the link: {}", name, llvm::toString(std::move(error)));
+        return false;
+    }
+    return true;
+}
+
+// Runs the thin link and the backends, then links the objects they produce
+bool ThinLink::Link(const std::string &executable)
+{
+    std::vector<llvm::SmallString<0>> objects(lto->getMaxTasks());
+    auto addStream = [&](unsigned task) {
+        return std::make_unique<llvm::lto::NativeObjectStream>(std::make_unique<llvm::raw_svector_ostream>(objects[task]));
+    };
+
+    if (auto error = lto->run(addStream))
+    {
+        Logging::Error("Unable to link {}: {}", executable, llvm::toString(std::move(error)));
+        return false;
+    }
+
+    std::vector<std::string> objectFiles;
+    bool written = true;
+    for (auto &object : objects)
+    {
+        if (object.empty())
+            continue;
+
+        int fd;
+        llvm::SmallString<128> objectFile;
+        if (auto error = llvm::sys::fs::createTemporaryFile("thinlto", "o", fd, objectFile))
+        {
+            Logging::Error("Unable to create an object file: {}", error.message());
+            written = false;
+            break;
+        }
+
+        llvm::raw_fd_ostream stream(fd, true);
+        stream << object;
+        objectFiles.push_back(std::string(objectFile.str()));
+    }
+
+    bool linked = written && ModuleUnit::LinkObjects(objectFiles, executable);
+    for (auto &objectFile : objectFiles)
+        llvm::sys::fs::remove(objectFile);
+    return linked;
+}
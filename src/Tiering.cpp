@@ -0,0 +1,215 @@
+#include <Tiering.hpp>
+#include <Log.hpp>
+
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/ExecutionEngine/Orc/Core.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+
+// Gives every definition an external name so the optimized tiers can refer back to it
+static void Externalize(llvm::Module &module)
+{
+    for (auto &global : module.global_values())
+    {
+        if (global.isDeclaration())
+            continue;
+        if (!global.hasName())
+            global.setName("tier.anonymous");
+        if (global.hasLocalLinkage())
+            global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+    }
+}
+
+TieredModule::TieredModule(llvm::orc::LLJIT &jit, OptimizationLevel level, uint32_t threshold) : jit{jit},
+                                                                                                  level{level},
+                                                                                                  threshold{threshold},
+                                                                                                  target{CodeGeneration::CreateHostTargetMachine(level)}
+{
+}
+
+TieredModule::~TieredModule()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+
+    if (worker.joinable())
+        worker.join();
+}
+
+// Instruments the module and adds it to the JIT, then starts optimizing hot functions
+llvm::Error TieredModule::Add(llvm::orc::ThreadSafeModule generated)
+{
+    auto request = llvm::JITEvaluatedSymbol(llvm::pointerToJITTargetAddress(&RequestTierUp), llvm::JITSymbolFlags::Exported);
+    if (auto error = jit.getMainJITDylib().define(llvm::orc::absoluteSymbols({{jit.mangleAndIntern("tier.request"), request}})))
+        return error;
+
+    // The snapshot keeps the layout the JIT runs the first tier with, so the optimized tiers agree with it
+    generated.withModuleDo([&](llvm::Module &module) {
+        module.setDataLayout(jit.getDataLayout());
+        module.setTargetTriple(jit.getTargetTriple().str());
+        Externalize(module);
+
+        llvm::raw_svector_ostream stream(bitcode);
+        llvm::WriteBitcodeToFile(module, stream);
+
+        Instrument(module);
+    });
+
+    if (auto error = jit.addIRModule(std::move(generated)))
+        return error;
+
+    for (auto &function : functions)
+    {
+        auto target = jit.lookup(function + ".target");
+        if (!target)
+            return target.takeError();
+        targets.push_back(llvm::jitTargetAddressToPointer<void **>(target->getAddress()));
+    }
+
+    worker = std::thread(&TieredModule::Work, this);
+    return llvm::Error::success();
+}
+
+// Puts a forwarding check and a call counter in front of every function body. The libc main only runs once so it is
+// left alone
+void TieredModule::Instrument(llvm::Module &module)
+{
+    auto &context = module.getContext();
+    llvm::IRBuilder<> builder(context);
+
+    auto int32 = builder.getInt32Ty();
+    auto bytePointer = builder.getInt8PtrTy();
+    auto request = llvm::Function::Create(llvm::FunctionType::get(builder.getVoidTy(), {bytePointer, int32}, false),
+                                          llvm::Function::ExternalLinkage, "tier.request", module);
+    auto self = llvm::ConstantExpr::getIntToPtr(builder.getIntN(sizeof(void *) * 8, reinterpret_cast<uintptr_t>(this)), bytePointer);
+
+    std::vector<llvm::Function *> instrumented;
+    for (auto &function : module)
+        if (!function.isDeclaration() && function.getName() != "main" && &function != request)
+            instrumented.push_back(&function);
+
+    for (auto function : instrumented)
+    {
+        auto name = function->getName().str();
+        auto index = static_cast<uint32_t>(functions.size());
+        functions.push_back(name);
+
+        auto pointerType = function->getType();
+        auto target = new llvm::GlobalVariable(module, pointerType, false, llvm::GlobalValue::ExternalLinkage, llvm::ConstantPointerNull::get(pointerType), name + ".target");
+        auto calls = new llvm::GlobalVariable(module, int32, false, llvm::GlobalValue::ExternalLinkage, builder.getInt32(0), name + ".calls");
+
+        auto body = &function->getEntryBlock();
+        auto entry = llvm::BasicBlock::Create(context, "tier.entry", function, body);
+        auto forward = llvm::BasicBlock::Create(context, "tier.forward", function, body);
+        auto count = llvm::BasicBlock::Create(context, "tier.count", function, body);
+        auto tierUp = llvm::BasicBlock::Create(context, "tier.up", function, body);
+
+        // Once the optimized version is published every call goes straight on to it
+        builder.SetInsertPoint(entry);
+        auto optimized = builder.CreateAlignedLoad(pointerType, target, llvm::MaybeAlign(sizeof(void *)));
+        optimized->setAtomic(llvm::AtomicOrdering::Acquire);
+        auto branch = builder.CreateCondBr(builder.CreateIsNotNull(optimized), forward, count);
+
+        // The allocas stay static in the new entry block
+        for (auto &instruction : llvm::make_early_inc_range(*body))
+            if (auto alloca = llvm::dyn_cast<llvm::AllocaInst>(&instruction); alloca && llvm::isa<llvm::Constant>(alloca->getArraySize()))
+                alloca->moveBefore(branch);
+
+        builder.SetInsertPoint(forward);
+        std::vector<llvm::Value *> arguments;
+        for (auto &argument : function->args())
+            arguments.push_back(&argument);
+        auto call = builder.CreateCall(function->getFunctionType(), optimized, arguments);
+        call->setCallingConv(function->getCallingConv());
+        call->setAttributes(function->getAttributes());
+        call->setTailCallKind(llvm::CallInst::TCK_MustTail);
+        if (call->getType()->isVoidTy())
+            builder.CreateRetVoid();
+        else
+            builder.CreateRet(call);
+
+        // The program runs on one thread, so a plain increment counts every call
+        builder.SetInsertPoint(count);
+        auto current = builder.CreateAdd(builder.CreateLoad(int32, calls), builder.getInt32(1));
+        builder.CreateStore(current, calls);
+        builder.CreateCondBr(builder.CreateICmpEQ(current, builder.getInt32(threshold)), tierUp, body);
+
+        builder.SetInsertPoint(tierUp);
+        builder.CreateCall(request, {self, builder.getInt32(index)});
+        builder.CreateBr(body);
+    }
+}
+
+void TieredModule::Work()
+{
+    while (true)
+    {
+        uint32_t index;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [this] { return stopping || !hot.empty(); });
+            if (stopping)
+                return;
+
+            index = hot.front();
+            hot.pop_front();
+        }
+        TierUp(index);
+    }
+}
+
+// Builds the optimized tier of a function from the uninstrumented module in a context of its own. The other
+// definitions are kept available externally so they can be inlined, whatever isn't resolves to the first tier
+void TieredModule::TierUp(uint32_t index)
+{
+    auto &name = functions[index];
+
+    auto context = std::make_unique<llvm::LLVMContext>();
+    auto module = llvm::parseBitcodeFile(llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()), name), *context);
+    if (!module)
+    {
+        Logging::Error("Unable to optimize {}: {}", name, llvm::toString(module.takeError()));
+        return;
+    }
+
+    auto function = (*module)->getFunction(name);
+    for (auto &global : (*module)->global_objects())
+        if (&global != function && !global.isDeclaration())
+            global.setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+
+    function->setName(name + ".optimized"); // Recursive calls now skip the first tier too
+    (*module)->setDataLayout(jit.getDataLayout());
+    (*module)->setTargetTriple(jit.getTargetTriple().str());
+    CodeGeneration::Optimize(**module, level, target.get());
+
+    if (auto error = jit.addIRModule(llvm::orc::ThreadSafeModule(std::move(*module), std::move(context))))
+    {
+        Logging::Error("Unable to optimize {}: {}", name, llvm::toString(std::move(error)));
+        return;
+    }
+
+    auto optimized = jit.lookup(name + ".optimized");
+    if (!optimized)
+    {
+        Logging::Error("Unable to optimize {}: {}", name, llvm::toString(optimized.takeError()));
+        return;
+    }
+
+    __atomic_store_n(targets[index], llvm::jitTargetAddressToPointer<void *>(optimized->getAddress()), __ATOMIC_RELEASE);
+}
+
+// Called by the instrumented functions on the program's thread
+void TieredModule::RequestTierUp(TieredModule *tiers, uint32_t index)
+{
+    {
+        std::lock_guard lock(tiers->mutex);
+        tiers->hot.push_back(index);
+    }
+    tiers->wake.notify_one();
+}
@@ -0,0 +1,81 @@
+#include <Token.hpp>
+#include <cstdlib>
+
+#ifdef PLATFORM_WINDOWS
+#include <fstream>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+SourceBuffer::SourceBuffer(const std::string &filename) : data{nullptr}, size{0}, mappedSize{0}
+{
+#ifdef PLATFORM_WINDOWS
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    auto length = file.tellg();
+    size = length > 0 ? static_cast<size_t>(length) : 0;
+    file.seekg(0, std::ios::beg);
+
+    mappedSize = size + SentinelSize;
+    data = new char[mappedSize];
+    memset(data, 0, mappedSize);
+    if (!file.read(data, size))
+    {
+        std::cerr << "Unable to read file: " << filename << std::endl;
+        size = 0;
+    }
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) < 0)
+        std::cerr << "Unable to read file: " << filename << std::endl;
+    else
+        size = static_cast<size_t>(info.st_size);
+
+    // Reserve zeroed pages for the file and the sentinel tail, then map the file over the front of them
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    mappedSize = (size + SentinelSize + pageSize - 1) / pageSize * pageSize;
+
+    void *base = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+    {
+        std::cerr << "Unable to map file: " << filename << std::endl;
+        std::abort();
+    }
+    data = static_cast<char *>(base);
+
+    if (size && mmap(data, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+        std::cerr << "Unable to map file: " << filename << std::endl;
+        size = 0;
+    }
+
+    if (fd >= 0)
+        close(fd);
+#endif
+
+    BuildLineTable();
+}
+
+SourceBuffer::~SourceBuffer()
+{
+#ifdef PLATFORM_WINDOWS
+    delete[] data;
+#else
+    munmap(data, mappedSize);
+#endif
+}
+
+void SourceBuffer::BuildLineTable()
+{
+    lineStarts.push_back(0);
+    for (size_t i = 0; i < size; i++)
+    {
+        if (data[i] == '\r' && data[i + 1] == '\n')
+            lineStarts.push_back(++i + 1);
+        else if (data[i] == '\r' || data[i] == '\n')
+            lineStarts.push_back(i + 1);
+    }
+}
@@ -5,8 +5,7 @@
 #include <tuple>
 #include <Colors.hpp>
 #include <Log.hpp>
-
-void print();
+#include <Scan.hpp>
 
 #define Try(expr)                                   \
     if ((current = std::get<0>(expr)) != TokenNull) \
@@ -29,7 +28,13 @@ TokenList &Tokenizer::Tokenize()
 
         fptr--;
         Token current = TokenNull;
-        if (c == ' ' || c == '\n' || c == '\r')
+        if (c == ' ')
+        {
+            fptr.Seek(Scan::SpacesEnd(fptr.GetPointer()));
+            current = TokenDisregard;
+            goto DONE_TRYING;
+        }
+        else if (c == '\n' || c == '\r')
         {
             if (c == '\n' || c == '\r' && (tokenList.size() == 0 || tokenList.back().type != TokenType::Newline))
             {
@@ -67,80 +72,55 @@ TokenList &Tokenizer::Tokenize()
     return this->tokenList;
 }
 
-Tokenizer::IterateType Tokenizer::IterateTrieRec(const TrieNode &node, bool use, Position startPosition)
+Tokenizer::IterateType Tokenizer::IterateTrie()
 {
-    char c = fptr++;
     auto pos = fptr.CalulatePosition();
+    auto start = fptr.GetPointer();
 
-    uint8_t s = 0;
-    for (int i = 0; i < node.n; i++)
+    TrieState state = TrieStartState;
+    TokenType type = TokenTypeNull;
+    int length = 0;
+    for (int i = 0; (state = TrieTransition(state, start[i])) != TrieDeadState; i++)
     {
-        auto f = fptr.Offset();
-        auto [token, sum] = IterateTrieRec(*(trie + node.i + s), use && node == c, startPosition);
-        s += sum;
-
-        if (use && token != TokenNull && node == c)
-            return std::make_tuple(token, s + 1);
-    }
-    auto f = fptr.Offset();
-    if (use && node.term && node == c)
-    {
-        if (node.GetType() == TokenType::LeftAngle)
-            angleIndex++;
-        else if (node.GetType() == TokenType::RightAngle)
-            angleIndex--;
-        else if (angleIndex > 0 && node.GetType() == TokenType::RightShift)
+        // Keep the longest match. `>>` inside generic arguments closes two of them instead
+        auto accept = trie_accept[state];
+        if (accept != TokenTypeNull && !(accept == TokenType::RightShift && angleIndex > 0))
         {
-            fptr--;
-            return std::make_tuple(TokenNull, s);
+            type = accept;
+            length = i + 1;
         }
-
-        auto str = std::string(TokenTypeString(node.GetType()));
-        str[0] = tolower(str[0]);
-        Token token(node.GetType(), Range(startPosition, pos), str);
-        return std::make_tuple(token, s + 1);
     }
 
-    fptr--;
-    f = fptr.Offset();
-    return std::make_tuple(TokenNull, s + 1);
-}
+    if (type == TokenTypeNull)
+        return std::make_tuple(TokenNull, 0);
 
-Tokenizer::IterateType Tokenizer::IterateTrie()
-{
-    uint8_t i = 0;
-    for (i = 0; i < trie_size;)
-    {
-        auto f = fptr.CalulatePosition();
-        auto [token, sum] = IterateTrieRec(*(trie + i), true, f);
-        i += sum;
-        if (token != TokenNull)
-            return std::make_tuple(token, i);
-    }
+    if (type == TokenType::LeftAngle)
+        angleIndex++;
+    else if (type == TokenType::RightAngle)
+        angleIndex--;
 
-    return std::make_tuple(TokenNull, i);
+    fptr += length;
+
+    Token token(type, Range(pos, fptr.CalulatePosition()), Slice(start));
+    return std::make_tuple(token, 0);
 }
 
 Tokenizer::IterateType Tokenizer::Identifier()
 {
     auto pos = fptr.CalulatePosition();
-    char c = fptr++;
+    char c = *fptr;
     if (isalpha(c) || c == '_')
     {
-        Token token(TokenType::Identifier);
-        do
-        {
-            token.raw += c;
-            c = fptr++;
-        } while (isalnum(c) || c == '_');
-        fptr--;
-        token.position.start = pos;
-        token.position.end = fptr.CalulatePosition();
+        auto start = fptr.GetPointer();
+        auto end = Scan::IdentifierEnd(start + 1);
+        fptr.Seek(end);
+
+        Token token(TokenType::Identifier, Range(pos, fptr.CalulatePosition()), Slice(start));
+        token.id = Interner::Intern(token.raw);
         return std::make_tuple(token, 0);
     }
     else
     {
-        fptr--;
         return std::make_tuple(TokenNull, 0);
     }
 }
@@ -148,8 +128,8 @@ Tokenizer::IterateType Tokenizer::Identifier()
 Tokenizer::IterateType Tokenizer::Integer()
 {
     auto pos = fptr.CalulatePosition();
+    auto start = fptr.GetPointer();
     char c = fptr++;
-    std::string str = "";
     if (c == '0')
     {
         switch (*fptr)
@@ -159,12 +139,11 @@ Tokenizer::IterateType Tokenizer::Integer()
             fptr++;
             while (isxdigit(c) || c == '_')
             {
-                str += c;
                 c = *fptr;
                 if (isxdigit(c) || c == '_')
                     fptr++;
             }
-            Token token(TokenType::HexInt, Range(pos, fptr.CalulatePosition()), str);
+            Token token(TokenType::HexInt, Range(pos, fptr.CalulatePosition()), Slice(start));
             return std::make_tuple(token, 0);
         }
         case 'q':
@@ -172,12 +151,11 @@ Tokenizer::IterateType Tokenizer::Integer()
             fptr++;
             while ((c >= '0' && c <= '7') || c == '_')
             {
-                str += c;
                 c = *fptr;
                 if ((c >= '0' && c <= '7') || c == '_')
                     fptr++;
             }
-            Token token(TokenType::OctInt, Range(pos, fptr.CalulatePosition()), str);
+            Token token(TokenType::OctInt, Range(pos, fptr.CalulatePosition()), Slice(start));
             return std::make_tuple(token, 0);
         }
         case 'b':
@@ -185,12 +163,11 @@ Tokenizer::IterateType Tokenizer::Integer()
             fptr++;
             while ((c >= '0' && c <= '1') || c == '_')
             {
-                str += c;
                 c = *fptr;
                 if ((c >= '0' && c <= '1') || c == '_')
                     fptr++;
             }
-            Token token(TokenType::BinInt, Range(pos, fptr.CalulatePosition()), str);
+            Token token(TokenType::BinInt, Range(pos, fptr.CalulatePosition()), Slice(start));
             return std::make_tuple(token, 0);
         }
         }
@@ -200,11 +177,10 @@ Tokenizer::IterateType Tokenizer::Integer()
 
         while (isdigit(c) || c == '_')
         {
-            str += c;
             c = fptr++;
         }
         fptr--;
-        Token token(TokenType::Integer, Range(pos, fptr.CalulatePosition()), str);
+        Token token(TokenType::Integer, Range(pos, fptr.CalulatePosition()), Slice(start));
         if (CheckPrimitiveTypeSize(token))
         {
             return std::make_tuple(TokenDisregard, 0);
@@ -221,30 +197,28 @@ Tokenizer::IterateType Tokenizer::Integer()
 Tokenizer::IterateType Tokenizer::Float()
 {
     auto pos = fptr.CalulatePosition();
+    auto start = fptr.GetPointer();
     char c = fptr++;
     bool decimal = false;
     bool exponent = false;
-    std::string str = "";
 
     if (isdigit(c))
     {
 
         while (isdigit(c) || c == '_')
         {
-            str += c;
             c = fptr++;
             if (c == '.')
             {
                 if (!decimal)
                 {
-                    str += c;
                     c = fptr++;
                     decimal = true;
                 }
                 else
                 {
                     fptr--;
-                    Token token(TokenType::Floating, Range(pos, fptr.CalulatePosition()), str);
+                    Token token(TokenType::Floating, Range(pos, fptr.CalulatePosition()), Slice(start));
                     return std::make_tuple(token, 0);
                 }
             }
@@ -252,7 +226,6 @@ Tokenizer::IterateType Tokenizer::Float()
             {
                 if (!exponent)
                 {
-                    str += c;
                     c = fptr++;
                     exponent = true;
                     if (!(isdigit(c) || c == '-'))
@@ -263,14 +236,13 @@ Tokenizer::IterateType Tokenizer::Float()
                     }
                     else
                     {
-                        str += c;
                         c = fptr++;
                     }
                 }
                 else
                 {
                     fptr--;
-                    Token token(TokenType::Floating, Range(pos, fptr.CalulatePosition()), str);
+                    Token token(TokenType::Floating, Range(pos, fptr.CalulatePosition()), Slice(start));
                     return std::make_tuple(token, 0);
                 }
             }
@@ -278,7 +250,7 @@ Tokenizer::IterateType Tokenizer::Float()
         fptr--;
         if (!decimal && !exponent)
         {
-            Token token(TokenType::Integer, Range(pos, fptr.CalulatePosition()), str);
+            Token token(TokenType::Integer, Range(pos, fptr.CalulatePosition()), Slice(start));
             if (CheckPrimitiveTypeSize(token))
             {
                 return std::make_tuple(TokenDisregard, 0);
@@ -288,10 +260,10 @@ Tokenizer::IterateType Tokenizer::Float()
         else if (decimal && c == '.')
         {
             fptr--;
-            Token token(TokenType::Integer, Range(pos, fptr.CalulatePosition()), str.substr(0, str.size() - 1));
+            Token token(TokenType::Integer, Range(pos, fptr.CalulatePosition()), Slice(start));
             return std::make_tuple(token, 0);
         }
-        Token token(TokenType::Floating, Range(pos, fptr.CalulatePosition()), str);
+        Token token(TokenType::Floating, Range(pos, fptr.CalulatePosition()), Slice(start));
         return std::make_tuple(token, 0);
     }
     else
@@ -310,7 +282,7 @@ bool Tokenizer::CheckPrimitiveTypeSize(const Token &integer)
     {
         (tokenList.end() - 1)->ivalue = integer.ivalue;
         (tokenList.end() - 1)->position.end = integer.position.end;
-        (tokenList.end() - 1)->raw += std::to_string(integer.ivalue);
+        (tokenList.end() - 1)->raw = std::string_view((tokenList.end() - 1)->raw.data(), (tokenList.end() - 1)->raw.size() + integer.raw.size());
         return true;
     }
     return false;
@@ -326,12 +298,12 @@ Tokenizer::IterateType Tokenizer::String()
     case '\'':
     {
         Token token(TokenType::String, Range(pos, fptr.CalulatePosition()));
-        c = fptr++;
-        do
-        {
-            token.raw += c;
-            c = fptr++;
-        } while (c != '"' && c != '\'');
+
+        // The first character always belongs to the body, even if it's a quote
+        auto body = fptr.GetPointer();
+        auto end = *body ? Scan::QuoteEnd(body + 1) : body;
+        token.raw = std::string_view(body, end - body);
+        fptr.Seek(end + 1);
         token.position.end = fptr.CalulatePosition();
         return std::make_tuple(token, 0);
     }
@@ -351,18 +323,12 @@ bool Tokenizer::Comment()
         {
         case '/':
         {
-            while (fptr != '\n' && fptr != '\r')
-            {
-                fptr++;
-            }
+            fptr.Seek(Scan::LineEnd(fptr.GetPointer()));
             return true;
         }
         case '*':
         {
-            while (!(fptr == '*' && fptr + 1 == '/'))
-            {
-                fptr++;
-            }
+            fptr.Seek(Scan::BlockCommentEnd(fptr.GetPointer()));
             fptr += 2;
             return true;
         }
@@ -370,40 +336,10 @@ bool Tokenizer::Comment()
     }
     case '#':
     {
-        while (fptr != '\n' && fptr != '\r')
-        {
-            fptr++;
-        }
+        fptr.Seek(Scan::LineEnd(fptr.GetPointer()));
         return true;
     }
     }
     fptr--;
     return false;
 }
-
-uint8_t print_trie(const TrieNode *const trie_node, int n)
-{
-    if (!trie_node)
-        return 0;
-    for (int i = 0; i < n; i++)
-        printf(" ");
-
-    printf("%c\n", trie_node->c + 97);
-
-    int s = 0;
-
-    for (int i = 0; i < trie_node->n; i++)
-    {
-        uint8_t index = trie_node->i;
-        s += print_trie(trie + index + s, n + 1);
-    }
-    return s + 1;
-}
-
-void print()
-{
-    for (size_t i = 0; i < trie_size;)
-    {
-        i += print_trie(trie + i, 0);
-    }
-}
\ No newline at end of file
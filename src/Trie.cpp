@@ -12,18 +12,6 @@ const TokenType TokenTypeNull = TokenType::Eof;
 const Token TokenNull = Token();
 const Token TokenDisregard = Token(TokenType::Disregard);
 
-size_t trie_size = sizeof(trie) / sizeof(trie[0]);
-
-bool operator==(const TrieNode &lhs, char rhs)
-{
-    return lhs.c == rhs;
-}
-
-bool operator!=(const TrieNode &lhs, char rhs)
-{
-    return lhs.c != rhs;
-}
-
 const char *TokenTypeString(TokenType e)
 {
 
@@ -10,6 +10,7 @@ typedef struct trienode
     struct trienode *children[NUM_CHARS];
     bool terminal;
     int size;
+    int state;
     char val[32];
 } trienode;
 void print_trie(trienode *root);
@@ -298,52 +299,81 @@ char *get_token_type(char *in)
     }
 }
 
-void calculate_rec(trienode *node, bool root, int *index)
+#define MAX_STATES 256
+
+trienode *states[MAX_STATES];
+int state_count = 2; // 0 is the dead state and 1 the start state
+int classes[NUM_CHARS];
+int class_count = 1; // Class 0 holds every byte that never appears in the trie
+
+void number_states(trienode *node)
 {
-    if (node && node->size > 0)
+    for (int i = 0; i < NUM_CHARS; i++)
     {
-        for (int i = 0; i < NUM_CHARS; i++)
+        if (node->children[i])
         {
-            if (node->children[i])
+            if (state_count == MAX_STATES)
             {
-                fprintf(out, "TrieNode('%c'", i);
-                if (node->children[i]->terminal)
-                {
-                    if (node->children[i]->size > 0)
-                    {
-                        fprintf(out, ",%d,%d,TokenType::%s,true,true", ++(*index), node->children[i]->size, get_token_type(node->children[i]->val));
-                        goto CALC;
-                    }
-                    else
-                    {
-                        fprintf(out, ",TokenType::%s", get_token_type(node->children[i]->val));
-                        ++(*index);
-                    }
-                }
-                else
-                {
-                    fprintf(out, ",%d,%d", ++(*index), node->children[i]->size);
-                }
-                if (root)
-                {
-                    fprintf(out, ",true");
-                }
-            CALC:
-                fprintf(out, "), // %d\n", (*index) - 1);
-                calculate_rec(node->children[i], false, index);
+                fprintf(stderr, "Too many trie states\n");
+                exit(EXIT_FAILURE);
             }
+            if (!classes[i])
+                classes[i] = class_count++;
+            node->children[i]->state = state_count;
+            states[state_count++] = node->children[i];
+            number_states(node->children[i]);
         }
     }
 }
 
+void write_row(trienode *node)
+{
+    int row[NUM_CHARS] = {0};
+    if (node)
+    {
+        for (int i = 0; i < NUM_CHARS; i++)
+        {
+            if (node->children[i])
+                row[classes[i]] = node->children[i]->state;
+        }
+    }
+    for (int i = 0; i < class_count; i++)
+        fprintf(out, "%d,", row[i]);
+}
+
 void calculate(trienode *root)
 {
+    root->state = 1;
+    states[1] = root;
+    number_states(root);
+
     out = fopen("src/TrieStructure.inc", "w");
     if (out == NULL)
         exit(EXIT_FAILURE);
-    fprintf(out, "#include<Token.hpp>\n#include<Trie.hpp>\nconst TrieNode trie[] = {\n");
-    int index = 0;
-    calculate_rec(root, true, &index);
+    fprintf(out, "#include<Token.hpp>\n#include<Trie.hpp>\n");
+
+    fprintf(out, "const uint8_t trie_classes[] = {");
+    for (int i = 0; i < NUM_CHARS; i++)
+        fprintf(out, "%s%d,", i % 32 ? "" : "\n", classes[i]);
+    fprintf(out, "\n};\n");
+    fprintf(out, "const uint8_t trie_class_count = %d;\n", class_count);
+
+    fprintf(out, "const uint8_t trie_transitions[] = {\n");
+    for (int i = 0; i < state_count; i++)
+    {
+        write_row(states[i]);
+        fprintf(out, " // %d\n", i);
+    }
+    fprintf(out, "};\n");
+
+    fprintf(out, "const TokenType trie_accept[] = {\n");
+    for (int i = 0; i < state_count; i++)
+    {
+        if (states[i] && states[i]->terminal)
+            fprintf(out, "TokenType::%s, // %d\n", get_token_type(states[i]->val), i);
+        else
+            fprintf(out, "TokenType::Eof, // %d\n", i);
+    }
     fprintf(out, "};\n");
     fclose(out);
 }
@@ -0,0 +1,84 @@
+// Times walking a parsed syntax tree through the virtual NumChildren/operator[] interface against the FlatTree
+// arrays. Built by the FlatTreeBench target, run as FlatTreeBench [file] [iterations]
+#include <Tokenizer.hpp>
+#include <Parser.hpp>
+#include <FlatTree.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace Parsing;
+
+thread_local size_t numCodeType = 2;
+thread_local size_t numCodeValue = 0;
+
+static size_t CountKind(const SyntaxNode &node, SyntaxType kind)
+{
+    size_t count = node.GetType() == kind ? 1 : 0;
+    for (uint32_t i = 0; i < node.NumChildren(); i++)
+        count += CountKind(node[i], kind);
+    return count;
+}
+
+// Runs fn iterations times and prints the average time of one run. The results are summed and printed so the
+// runs can't be optimized away
+template <typename Fn>
+static void Time(const char *name, unsigned iterations, Fn fn)
+{
+    size_t result = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < iterations; i++)
+        result += fn();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << name << ": " << elapsed.count() / iterations << " ns (" << result / iterations << ")" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename = argc > 1 ? argv[1] : "examples/input.dsl";
+    unsigned iterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000;
+    if (iterations == 0)
+        iterations = 1;
+
+    FileIterator fptr(filename);
+    Tokenizer tokenizer(fptr);
+    auto &tokenList = tokenizer.Tokenize();
+    if (tokenizer.IsDirty())
+        return 1;
+
+    Arena arena;
+    Parser parser(tokenList, arena);
+    const SyntaxNode &tree = *parser.Parse();
+    FlatTree flatTree(tree);
+
+    std::cout << filename << ": " << flatTree.Size() << " nodes, " << iterations << " iterations" << std::endl;
+
+    Time("Build flat tree", iterations, [&] { return FlatTree(tree).Size(); });
+
+    // Every node, the shape of a whole tree pass
+    Time("Pointer tree, count identifiers", iterations, [&] { return CountKind(tree, SyntaxType::IdentifierExpression); });
+    Time("Flat tree, count identifiers", iterations, [&] {
+        size_t count = 0;
+        flatTree.ForEach(SyntaxType::IdentifierExpression, [&](FlatTree::Index) { count++; });
+        return count;
+    });
+
+    // The root's children only, the shape of CodeGeneration::PreCodeGen's sort
+    Time("Pointer tree, top level functions", iterations, [&] {
+        size_t count = 0;
+        for (uint32_t i = 0; i < tree.NumChildren(); i++)
+            count += tree[i].GetType() == SyntaxType::FunctionDeclerationStatement ? 1 : 0;
+        return count;
+    });
+    Time("Flat tree, top level functions", iterations, [&] {
+        size_t count = 0;
+        flatTree.ForEachChild(FlatTree::Root, [&](FlatTree::Index statement) {
+            count += flatTree.Kind(statement) == SyntaxType::FunctionDeclerationStatement ? 1 : 0;
+        });
+        return count;
+    });
+
+    return 0;
+}
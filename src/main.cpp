@@ -1,89 +1,140 @@
-#include <llvm/IR/Type.h>
-#include <llvm/IR/LegacyPassManager.h>
-#include <llvm/MC/SubtargetFeature.h>
-#include <llvm/ADT/StringMap.h>
-#include <llvm/ADT/Optional.h>
-#include <llvm/Support/TargetSelect.h>
-#include <llvm/Support/TargetRegistry.h>
-#include <llvm/Support/CodeGen.h>
-#include <llvm/Target/TargetOptions.h>
-#include <llvm/Target/TargetMachine.h>
-#include <llvm/Support/Host.h>
 #include <Tokenizer.hpp>
 #include <Parser.hpp>
 #include <ModuleUnit.hpp>
-#include <llvm/IR/Mangler.h>
+#include <ThinLink.hpp>
+#include <Log.hpp>
 
-size_t numCodeType = 2;
-size_t numCodeValue = 0;
+#include <llvm/Support/raw_ostream.h>
 
-int main()
-{
-    ModuleUnit module("examples/input.dsl", "input");
-    module.Compile();
-    module.DumpIR();
-
-    // mod->GetGen().GetModule().print(outputFile, nullptr);
-    // PrintSymbols(mod->GetGen().rootSymbols);
-
-    // auto targetTriple = llvm::sys::getDefaultTargetTriple();
-
-    // llvm::InitializeAllTargetInfos();
-    // llvm::InitializeAllTargets();
-    // llvm::InitializeAllTargetMCs();
-    // llvm::InitializeAllAsmParsers();
-    // llvm::InitializeAllAsmPrinters();
-
-    // std::string Error;
-    // auto target = llvm::TargetRegistry::lookupTarget(targetTriple, Error);
-
-    // if (!target)
-    // {
-    //     llvm::errs() << Error;
-    //     return 1;
-    // }
-
-    // auto targetName = target->getName();
-    // llvm::SubtargetFeatures features;
-    // llvm::StringMap<bool> hostFeatures;
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <limits>
+#include <string_view>
+#include <thread>
 
-    // if (llvm::sys::getHostCPUFeatures(hostFeatures))
-    //     for (auto &f : hostFeatures)
-    //         features.AddFeature(f.first(), f.second);
+thread_local size_t numCodeType = 2;
+thread_local size_t numCodeValue = 0;
 
-    // llvm::TargetOptions opt;
-    // auto RM = llvm::Optional<llvm::Reloc::Model>();
-    // auto CM = llvm::Optional<llvm::CodeModel::Model>();
-    // auto optimization = llvm::CodeGenOpt::Level::None;
-    // auto targetMachine = target->createTargetMachine(targetTriple, targetName, features.getString(), opt, RM, CM, optimization);
-    // auto DL = targetMachine->createDataLayout();
-
-    // llvm::Mangler::getNameWithPrefix(llvm::outs(), "Function", DL);
-    // // targetMachine.getDa
-    // mod->GetGen().GetModule().setDataLayout(targetMachine->createDataLayout());
-    // mod->GetGen().GetModule().setTargetTriple(targetTriple);
-
-    // auto filename = "out.o";
-    // llvm::raw_fd_ostream dest(filename, error);
-
-    // if (error)
-    // {
-    //     llvm::errs() << "Could not open file: " << error.message();
-    //     return 1;
-    // }
-
-    // llvm::legacy::PassManager pass;
-    // auto FileType = llvm::CGFT_ObjectFile;
+// Reads the whole of value as a decimal count, or reports it as the value of option
+static bool ParseCount(std::string_view option, std::string_view value, uint32_t &count)
+{
+    auto end = value.data() + value.size();
+    auto [last, error] = std::from_chars(value.data(), end, count);
+    if (error == std::errc() && last == end)
+        return true;
 
-    // if (targetMachine->addPassesToEmitFile(pass, dest, nullptr, FileType))
-    // {
-    //     llvm::errs() << "TargetMachine can't emit a file of this type";
-    //     return 1;
-    // }
+    Logging::Error("Invalid value {} for {}, expected a number from 0 to {}", value, option, std::numeric_limits<uint32_t>::max());
+    return false;
+}
 
-    // pass.run(mod->GetGen().GetModule());
-    // dest.flush();
+int main(int argc, char **argv)
+{
+    std::vector<std::string> files;
+    OptimizationLevel optimization = OptimizationLevel::O0;
+    uint32_t jobs = 0;
+    OutputKind output = OutputKind::IR;
+    std::string outputPath;
+    bool run = false;
+    uint32_t tierThreshold = 0;
+    bool thinLTO = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg = argv[i];
+        if (arg == "-O0")
+            optimization = OptimizationLevel::O0;
+        else if (arg == "-O1")
+            optimization = OptimizationLevel::O1;
+        else if (arg == "-O2")
+            optimization = OptimizationLevel::O2;
+        else if (arg == "-O3")
+            optimization = OptimizationLevel::O3;
+        else if (arg == "-Os")
+            optimization = OptimizationLevel::Os;
+        else if (arg == "-Oz")
+            optimization = OptimizationLevel::Oz;
+        else if (arg == "-j" && i + 1 < argc)
+        {
+            if (!ParseCount(arg, argv[++i], jobs))
+                return 1;
+        }
+        else if (arg == "-bc")
+            output = OutputKind::Bitcode;
+        else if (arg == "-S")
+            output = OutputKind::Assembly;
+        else if (arg == "-c")
+            output = OutputKind::Object;
+        else if (arg == "-exe")
+            output = OutputKind::Executable;
+        else if (arg == "-o" && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (arg == "-run")
+            run = true;
+        else if (arg == "-tiered" && i + 1 < argc)
+        {
+            run = true;
+            if (!ParseCount(arg, argv[++i], tierThreshold))
+                return 1;
+        }
+        else if (arg == "-thinlto")
+            thinLTO = true;
+        else if (!arg.empty() && arg[0] != '-')
+            files.emplace_back(arg);
+        else
+        {
+            Logging::Error("Unknown option {}", arg);
+            return 1;
+        }
+    }
+
+    if (files.empty())
+        files.push_back("examples/input.dsl");
+
+    // More threads than cores only adds contention
+    jobs = std::min(jobs, std::max(std::thread::hardware_concurrency(), 1u));
+
+    // Every file is compiled to bitcode on its own, then they are linked into one executable
+    if (thinLTO)
+    {
+        if (run || (output != OutputKind::IR && output != OutputKind::Executable))
+        {
+            Logging::Error("-thinlto only links an executable, it can't be used with -run, -tiered, -S, -c or -bc");
+            return 1;
+        }
+
+        ThinLink link(optimization, jobs);
+        for (auto &file : files)
+        {
+            ModuleUnit module(file, std::filesystem::path(file).stem().string());
+            module.SetOptimizationLevel(optimization);
+            module.SetJobs(jobs);
+            module.SetOutput(OutputKind::Bitcode);
+            module.Compile();
+
+            llvm::SmallVector<char, 0> bitcode;
+            llvm::raw_svector_ostream stream(bitcode);
+            if (!module.WriteBitcode(stream) || !link.Add(file, std::move(bitcode)))
+                return 1;
+        }
+        return link.Link(outputPath.empty() ? "out" : outputPath) ? 0 : 1;
+    }
+
+    if (files.size() > 1)
+    {
+        Logging::Error("Only -thinlto takes more than one file");
+        return 1;
+    }
+
+    ModuleUnit module(files[0], std::filesystem::path(files[0]).stem().string());
+    module.SetOptimizationLevel(optimization);
+    module.SetJobs(jobs);
+    module.SetOutput(output);
+    module.SetOutputPath(outputPath);
+    module.SetTierThreshold(tierThreshold);
 
-    // std::cout << "Code Value: " << numCodeValue << ", Code Type: " << numCodeType << std::endl;
-    return 0;
-}
\ No newline at end of file
+    module.Compile();
+    if (run)
+        return module.Run();
+    return module.Emit() ? 0 : 1;
+}